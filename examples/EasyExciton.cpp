@@ -4,14 +4,11 @@
 #include "Engine.h"
 #include "GeometryLibrary.h"
 #include "TypeToString.h"
-#include "CreationOrDestructionOp.h"
-#include "HilbertState.h"
-#include "EtoTheIhTime.h"
-#include "DiagonalOperator.h"
 #include "GeometryParameters.h"
 #include "Concurrency.h"
 #include "InputNg.h"
 #include "InputCheck.h"
+#include "TimePropagator.h"
 
 typedef double RealType;
 typedef std::complex<double> ComplexType;
@@ -22,12 +19,8 @@ typedef PsimagLite::InputNg<FreeFermions::InputCheck> InputNgType;
 typedef FreeFermions::GeometryParameters<RealType,InputNgType::Readable> GeometryParamsType;
 typedef FreeFermions::GeometryLibrary<MatrixType,GeometryParamsType> GeometryLibraryType;
 typedef FreeFermions::Engine<RealType,FieldType> EngineType;
-typedef FreeFermions::CreationOrDestructionOp<EngineType> OperatorType;
-typedef FreeFermions::EToTheIhTime<EngineType> EtoTheIhTimeType;
-typedef FreeFermions::DiagonalOperator<EtoTheIhTimeType> DiagonalOperatorType;
-typedef FreeFermions::HilbertState<OperatorType,DiagonalOperatorType> HilbertStateType;
-typedef DiagonalOperatorType::FactoryType OpDiagonalFactoryType;
-typedef OperatorType::FactoryType OpNormalFactoryType;
+typedef FreeFermions::TimePropagator<EngineType> TimePropagatorType;
+typedef TimePropagatorType::MatrixComplexType MatrixComplexType;
 
 int main(int argc,char *argv[])
 {
@@ -37,8 +30,9 @@ int main(int argc,char *argv[])
 	RealType offset = 0;
 	RealType step = 0;
 	SizeType site3 = 0;
+	bool allSites = false;
 
-	while ((opt = getopt(argc, argv, "f:t:o:i:p:")) != -1) {
+	while ((opt = getopt(argc, argv, "f:t:o:i:p:a")) != -1) {
 		switch (opt) {
 		case 'f':
 			file=optarg;
@@ -55,6 +49,9 @@ int main(int argc,char *argv[])
 		case 'p':
 			site3 = atoi(optarg);
 			break;
+		case 'a':
+			allSites = true;
+			break;
 		default: /* '?' */
 			throw std::runtime_error("Wrong usage\n");
 		}
@@ -86,32 +83,40 @@ int main(int argc,char *argv[])
 	EngineType engine(geometry.matrix(),
 	                  geometryParams.outputFile,
 	                  dof,
-	                  EngineType::VerboseEnum::YES);
+	                  EngineType::VerboseEnum::YES,
+	                  geometryParams.engineOptions);
 	PsimagLite::Vector<SizeType>::Type ne(dof,electronsUp); // 8 up and 8 down
-	bool debug = false;
-	HilbertStateType gs(engine,ne,debug);
 
-	SizeType sigma =0;
-	OpNormalFactoryType opNormalFactory(engine);
-	OperatorType& myOp = opNormalFactory(OperatorType::CREATION,sites[0],sigma);
-	HilbertStateType phi2 = gs;
-	myOp.applyTo(phi2);
-	
-	FieldType density = scalarProduct(phi2,phi2);
+	// |c_j e^{-iHt} c^dagger_i gs|^2 = |G_empty(j,i;t)|^2 + <n_j> <c_i c^dagger_i>,
+	// with G_empty(j,i;t) = conj(G_empty(i,j;-t)), so row i at -t
+	TimePropagatorType::VectorSizeType applyRow(1,sites[0]);
+	TimePropagatorType empty(engine,
+	                         ne[0],
+	                         TimePropagatorType::LevelsEnum::EMPTY,
+	                         applyRow);
+	TimePropagatorType occupied(engine,ne[0],TimePropagatorType::LevelsEnum::OCCUPIED);
+	RealType density = PsimagLite::real(empty(0)(0,sites[0]));
+	const MatrixComplexType& g0 = occupied(0);
+	PsimagLite::Vector<RealType>::Type nj(engine.size());
+	for (SizeType j = 0; j < nj.size(); j++) nj[j] = PsimagLite::real(g0(j,j));
 	std::cerr<<"density="<<density<<"\n";
-	
+
 	std::cout<<"#site(apply)="<<sites[0]<<"\n";
-	std::cout<<"#site2(measure)="<<sites[1]<<"\n";
-	for (SizeType it = 0; it<total; it++) {
-		OpDiagonalFactoryType opDiagonalFactory(engine);
-		RealType time = it * step + offset;
-		EtoTheIhTimeType eih(time,engine,0);
-		DiagonalOperatorType& eihOp = opDiagonalFactory(eih);
-		HilbertStateType phi = gs;
-		myOp.applyTo(phi);
-		eihOp.applyTo(phi);
-		OperatorType& myOp2 = opNormalFactory(OperatorType::DESTRUCTION, sites[1], sigma);
-		myOp2.applyTo(phi);
-		std::cout<<time<<" "<<scalarProduct(phi,phi)/density<<"\n";
-	}
+	if (allSites)
+		std::cout<<"#site2(measure)=all\n";
+	else
+		std::cout<<"#site2(measure)="<<sites[1]<<"\n";
+
+	// -a measures every site, a light cone
+	empty.sweep(total,-offset,-step,[&](SizeType, RealType minusTime, const MatrixComplexType& g)
+	{
+		std::cout<<(-minusTime);
+		for (SizeType j = 0; j < nj.size(); j++) {
+			if (!allSites && j != sites[1]) continue;
+			FieldType value = std::norm(g(0,j))/density + nj[j];
+			std::cout<<" "<<value;
+		}
+
+		std::cout<<"\n";
+	});
 }
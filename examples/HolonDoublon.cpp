@@ -89,7 +89,8 @@ int main(int argc,char *argv[])
 	EngineType engine(geometry.matrix(),
 	                  geometryParams.outputFile,
 	                  dof,
-	                  EngineType::VerboseEnum::YES);
+	                  EngineType::VerboseEnum::YES,
+	                  geometryParams.engineOptions);
 
 	PsimagLite::Vector<SizeType>::Type ne(dof,electronsUp); // 8 up and 8 down
 	bool debug = false;
@@ -84,7 +84,8 @@ int main(int argc,char *argv[])
 	EngineType engine(geometry.matrix(),
 	                  geometryParams.outputFile,
 	                  dof,
-	                  EngineType::VerboseEnum::YES);
+	                  EngineType::VerboseEnum::YES,
+	                  geometryParams.engineOptions);
 
 	PsimagLite::Vector<SizeType>::Type ne(dof,electronsUp);
 	bool debug = false;
@@ -101,16 +102,25 @@ int main(int argc,char *argv[])
 	std::cerr<<"density="<<density<<" energy="<<energy<<"\n";
 
 	std::cout<<"#site="<<sites[0]<<"\n";
+	if (total == 0) return 0;
+
+	// one grid of times, so that one enumeration serves all time steps
+	PsimagLite::Vector<RealType>::Type times(total);
+	for (SizeType it = 0; it<total; it++)
+		times[it] = it * step + offset;
+
+	OpDiagonalFactoryType opDiagonalFactory(engine);
+	EtoTheIhTimeType eih(times,engine,0);
+	DiagonalOperatorType& eihOp = opDiagonalFactory(eih);
+	HilbertStateType phi = phi2;
+	eihOp.applyTo(phi);
+	PsimagLite::Vector<ComplexType>::Type values;
+	scalarProduct(values,phi2,phi);
 	for (SizeType it = 0; it<total; it++) {
-		OpDiagonalFactoryType opDiagonalFactory(engine);
-		RealType time = it * step + offset;
-		EtoTheIhTimeType eih(time,engine,0);
-		DiagonalOperatorType& eihOp = opDiagonalFactory(eih);
-		HilbertStateType phi = phi2;
-		eihOp.applyTo(phi);
+		RealType time = times[it];
 		RealType arg = energy*time;
 		ComplexType expFactor(cos(arg), -sin(arg));
-		ComplexType tmp = scalarProduct(phi2,phi);
+		ComplexType tmp = values[it];
 		tmp -= expFactor*density*density;
 		tmp*= (0.5*expFactor);
 		std::cout<<time<<" "<<tmp<<"\n";
@@ -276,7 +276,8 @@ int main(int argc,char *argv[])
 	EngineType engine(geometry.matrix(),
 	                  geometryParams.outputFile,
 	                  dof,
-	                  EngineType::VerboseEnum::YES);
+	                  EngineType::VerboseEnum::YES,
+	                  geometryParams.engineOptions);
 
 	PsimagLite::Vector<SizeType>::Type ne(dof,electronsUp);
 	bool debug = false;
@@ -30,7 +30,7 @@ typedef FreeFermions::CreationOrDestructionOp<EngineType> OperatorType;
 typedef FreeFermions::EToTheIhTime<EngineType> EtoTheIhTimeType;
 typedef FreeFermions::DiagonalOperator<EtoTheIhTimeType> DiagonalOperatorType;
 typedef FreeFermions::HilbertState<OperatorType,DiagonalOperatorType> HilbertStateType;
-typedef PsimagLite::Vector<HilbertStateType*>::Type VectorHilbertStateType;
+typedef HilbertStateType::VectorThisType VectorHilbertStateType;
 typedef DiagonalOperatorType::FactoryType OpDiagonalFactoryType;
 typedef OperatorType::FactoryType OpNormalFactoryType;
 typedef PsimagLite::Vector<RealType>::Type VectorRealType;
@@ -58,22 +58,14 @@ void computeOneBucket(HilbertStateType& phi,
 ComplexType bucketFinal(const VectorHilbertStateType& buckets, const VectorType& weights)
 {
 	SizeType total = buckets.size();
-	MatrixType m(total,total);
-	for (SizeType i = 0; i < total; ++i) {
-		for (SizeType j = i; j < total; ++j) {
-			m(i, j) = scalarProduct(*buckets[i],*buckets[j]);
-		}
-	}
-
-	for (SizeType i = 0; i < total; ++i) delete buckets[i];
+	// m(i,j) = <bucket i|bucket j>, expanding each bucket only once
+	MatrixType m;
+	HilbertStateType::scalarProducts(m,buckets,buckets);
 
 	ComplexType result = 0;
-	for (SizeType i = 0; i < total; ++i) {
-		for (SizeType j = 0; j < total; ++j) {
-			ComplexType value = (j > i) ? PsimagLite::conj(m(i,j)) : m(j,i);
-			result += PsimagLite::conj(weights[i])*weights[j]*value;
-		}
-	}
+	for (SizeType i = 0; i < total; ++i)
+		for (SizeType j = 0; j < total; ++j)
+			result += PsimagLite::conj(weights[i])*weights[j]*m(j,i);
 
 	return result;
 }
@@ -91,12 +83,11 @@ ComplexType doOneTime(RealType time,
 	EtoTheIhTimeType eih(time, engine, 0);
 	DiagonalOperatorType& eihOp = opDiagonalFactory(eih);
 	SizeType total = sites.size();
-	VectorHilbertStateType buckets(total);
+	VectorHilbertStateType buckets(total,gs);
 	for (SizeType i = 0; i < total; ++i) {
 		const SizeType site = sites[i];
-		buckets[i] = new HilbertStateType(gs);
-		computeOneBucket(*buckets[i], opNormalFactory, &eihOp, site, totalSites);
-		opCp.applyTo(*buckets[i]);
+		computeOneBucket(buckets[i], opNormalFactory, &eihOp, site, totalSites);
+		opCp.applyTo(buckets[i]);
 	}
 
 	return bucketFinal(buckets, weights);
@@ -157,11 +148,10 @@ ComplexType superDensity(const HilbertStateType& gs,
 {
 	SizeType total = sites.size();
 	OpNormalFactoryType opNormalFactory(engine);
-	VectorHilbertStateType buckets(total,0);
+	VectorHilbertStateType buckets(total,gs);
 	for (SizeType i = 0; i < sites.size(); ++i) {
 		SizeType site = sites[i];
-		buckets[i] = new HilbertStateType(gs);
-		computeOneBucket(*buckets[i], opNormalFactory, nullptr, site, totalSites);
+		computeOneBucket(buckets[i], opNormalFactory, nullptr, site, totalSites);
 	}
 
 	return bucketFinal(buckets, weights);
@@ -252,7 +242,8 @@ int main(int argc,char *argv[])
 	EngineType engine(geometry.matrix(),
 	                  geometryParams.outputFile,
 	                  dof,
-	                  EngineType::VerboseEnum::YES);
+	                  EngineType::VerboseEnum::YES,
+	                  geometryParams.engineOptions);
 
 	PsimagLite::Vector<SizeType>::Type ne(dof,electronsUp);
 	bool debug = false;
@@ -7,12 +7,12 @@
 #include "Engine.h"
 #include "GeometryLibrary.h"
 #include "TypeToString.h"
-#include "CreationOrDestructionOp.h"
-#include "HilbertState.h"
 #include "GeometryParameters.h"
 #include "Concurrency.h"
 #include "InputNg.h"
 #include "InputCheck.h"
+#include "FillingScan.h"
+#include "CorrelationMatrix.h"
 
 typedef double RealType;
 typedef std::complex<double> ComplexType;
@@ -23,9 +23,8 @@ typedef PsimagLite::InputNg<FreeFermions::InputCheck> InputNgType;
 typedef FreeFermions::GeometryParameters<FieldType,InputNgType::Readable> GeometryParamsType;
 typedef FreeFermions::GeometryLibrary<MatrixType,GeometryParamsType> GeometryLibraryType;
 typedef FreeFermions::Engine<RealType,FieldType> EngineType;
-typedef FreeFermions::CreationOrDestructionOp<EngineType> OperatorType;
-typedef FreeFermions::HilbertState<OperatorType> HilbertStateType;
-typedef OperatorType::FactoryType OpNormalFactoryType;
+typedef FreeFermions::FillingScan<EngineType> FillingScanType;
+typedef FreeFermions::CorrelationMatrix<EngineType> CorrelationMatrixType;
 
 void verify(MatrixType cicj, const EngineType& engine)
 {
@@ -43,8 +42,9 @@ int main(int argc,char* argv[])
 	PsimagLite::String file("");
 	bool energyOnly = false;
 	SizeType prec = 8;
+	SizeType lastFilling = 0;
 
-	while ((opt = getopt(argc, argv, "f:ep:")) != -1) {
+	while ((opt = getopt(argc, argv, "f:ep:s:")) != -1) {
 		switch (opt) {
 		case 'f':
 			file=optarg;
@@ -55,6 +55,9 @@ int main(int argc,char* argv[])
 		case 'p':
 			prec = atoi(optarg);
 			break;
+		case 's':
+			lastFilling = atoi(optarg);
+			break;
 		default: /* '?' */
 			throw std::runtime_error("Wrong usage\n");
 		}
@@ -82,40 +85,47 @@ int main(int argc,char* argv[])
 	EngineType engine(geometry.matrix(),
 	                  geometryParams.outputFile,
 	                  dof,
-	                  EngineType::VerboseEnum::YES);
+	                  EngineType::VerboseEnum::YES,
+	                  geometryParams.engineOptions);
 	PsimagLite::Vector<SizeType>::Type ne(dof,electronsUp);
-	HilbertStateType gs(engine,ne);
-	RealType sum = 0;
-	for (SizeType i=0;i<ne[0];i++) sum += engine.eigenvalue(i);
-	std::cerr<<"Energy="<<dof*sum<<"\n";
-
-	if (energyOnly) return 0;
+	std::cerr<<"Energy="<<dof*engine.energy(ne[0])<<"\n";
 
 	SizeType sigma = 0;
 	SizeType n = geometryParams.sites;
 	SizeType norb = 1;
 	io.readline(norb,"Orbitals=");
-	for (SizeType orbital=0; orbital<norb; orbital++) {
-		MatrixType cicj(n,n);
-		for (SizeType site = 0; site < n; site++) {
-			OpNormalFactoryType opNormalFactory(engine);
-			OperatorType& myOp = opNormalFactory(OperatorType::DESTRUCTION,
-			                                     site+orbital*geometryParams.sites,
-			                                     sigma);
-			for (SizeType site2 = site ; site2 < n; site2++) {
-				HilbertStateType phi = gs;
-				myOp.applyTo(phi);
-				OperatorType& myOp2 = opNormalFactory(OperatorType::CREATION,
-				                                      site2+orbital*geometryParams.sites,
-				                                      sigma);
-				myOp2.applyTo(phi);
-				cicj(site,site2) += scalarProduct(gs,phi);
+
+	// -s last scans fillings TargetElectronsUp to last with rank-1 updates
+	if (lastFilling > 0) {
+		FillingScanType scan(engine,electronsUp,!energyOnly);
+		while (true) {
+			std::cout<<"#Filling="<<scan.filling()<<" Energy="<<dof*scan.energy()<<"\n";
+			for (SizeType orbital=0; orbital<norb && !energyOnly; orbital++) {
+				SizeType offset = orbital*geometryParams.sites;
+				MatrixType cicj(n,n);
+				for (SizeType site = 0; site < n; site++)
+					for (SizeType site2 = 0; site2 < n; site2++)
+						cicj(site,site2) = scan.correlations()(site2+offset,site+offset);
+				std::cout<<cicj;
 			}
+
+			if (scan.filling() >= lastFilling || scan.full()) break;
+			scan.next();
 		}
 
+		return 0;
+	}
+
+	if (energyOnly) return 0;
+
+	// cicj(site,site2) = <c^dagger_site2 c_site>
+	CorrelationMatrixType correlations(engine,ne,norb);
+	for (SizeType orbital=0; orbital<norb; orbital++) {
+		const MatrixType& c = correlations(sigma,orbital);
+		MatrixType cicj(n,n);
 		for (SizeType site = 0; site < n; site++)
-			for (SizeType site2 = site + 1; site2 < n; site2++)
-				cicj(site2, site) = PsimagLite::conj(cicj(site, site2));
+			for (SizeType site2 = 0; site2 < n; site2++)
+				cicj(site,site2) = c(site2,site);
 
 		std::cout<<cicj;
 
@@ -4,12 +4,6 @@
 #include "Engine.h"
 #include "GeometryLibrary.h"
 #include "TypeToString.h"
-#include "CreationOrDestructionOp.h"
-#include "HilbertState.h"
-#include "EtoTheBetaH.h"
-#include "DiagonalOperator.h"
-#include "LibraryOperator.h"
-#include "Combinations.h"
 #include "GeometryParameters.h"
 #include "Vector.h"
 #include "Concurrency.h"
@@ -24,25 +18,13 @@ typedef PsimagLite::InputNg<FreeFermions::InputCheck> InputNgType;
 typedef FreeFermions::GeometryParameters<RealType,InputNgType::Readable> GeometryParamsType;
 typedef FreeFermions::GeometryLibrary<MatrixType,GeometryParamsType> GeometryLibraryType;
 typedef FreeFermions::Engine<RealType,FieldType> EngineType;
-typedef FreeFermions::CreationOrDestructionOp<EngineType> OperatorType;
-typedef FreeFermions::EToTheBetaH<EngineType> EtoTheBetaHType;
-typedef FreeFermions::DiagonalOperator<EtoTheBetaHType> DiagonalOperatorType;
-typedef FreeFermions::HilbertState<OperatorType,DiagonalOperatorType> HilbertStateType;
-typedef DiagonalOperatorType::FactoryType OpDiagonalFactoryType;
-typedef OperatorType::FactoryType OpNormalFactoryType;
-typedef FreeFermions::LibraryOperator<OperatorType> LibraryOperatorType;
-typedef LibraryOperatorType::FactoryType OpLibFactoryType;
-
-RealType fermi(const RealType& x)
-{
-	return 1.0/(1.0+exp(x));
-}
+typedef EngineType::VectorThermalPointType VectorThermalPointType;
 
 int main(int argc,char *argv[])
 {
 	int opt;
 	PsimagLite::String file("");
-	RealType beta = 0;
+	PsimagLite::String betas("0");
 	RealType mu=0;
 
 	while ((opt = getopt(argc, argv, "f:m:b:")) != -1) {
@@ -54,7 +36,7 @@ int main(int argc,char *argv[])
 			mu = atof(optarg);
 			break;
 		case 'b':
-			beta = atof(optarg);
+			betas = optarg;
 			break;
 		default: /* '?' */
 			throw std::runtime_error("Wrong usage\n");
@@ -65,6 +47,28 @@ int main(int argc,char *argv[])
 		throw std::runtime_error("Wrong usage\n");
 	}
 
+	// -b takes one beta or a comma-separated sweep of them;
+	// empty entries, as in 1,2, are skipped
+	VectorThermalPointType points;
+	PsimagLite::String::size_type start = 0;
+	while (start <= betas.length()) {
+		PsimagLite::String::size_type end = betas.find(',',start);
+		if (end == PsimagLite::String::npos) end = betas.length();
+		PsimagLite::String token = betas.substr(start,end - start);
+		start = end + 1;
+		if (token.find_first_not_of(" \t") == PsimagLite::String::npos) continue;
+
+		char* rest = 0;
+		RealType beta = strtod(token.c_str(),&rest);
+		if (PsimagLite::String(rest).find_first_not_of(" \t") != PsimagLite::String::npos)
+			throw std::runtime_error("-b: " + token + " is not a number\n");
+		points.push_back(EngineType::ThermalPointType(beta,mu));
+	}
+
+	if (points.size() == 0) {
+		throw std::runtime_error("-b: no beta given\n");
+	}
+
 	FreeFermions::InputCheck inputCheck;
 	InputNgType::Writeable ioWriteable(file,inputCheck);
 	InputNgType::Readable io(ioWriteable);
@@ -79,45 +83,37 @@ int main(int argc,char *argv[])
 	EngineType engine(geometry.matrix(),
 	                  geometryParams.outputFile,
 	                  dof,
-	                  EngineType::VerboseEnum::YES);
+	                  EngineType::VerboseEnum::YES,
+	                  geometryParams.engineOptions);
 
 	SizeType n = engine.size();
 
 	std::cout<<geometry;
-	std::cout<<"#beta="<<beta<<" mu="<<mu<<"\n";
-
-	PsimagLite::Vector<RealType>::Type ni(n);
-	RealType density = 0.0;
-	RealType energy = 0.0;
-	for (SizeType i=0;i<n;i++) {
-		for (SizeType j=0;j<n;j++) {
-			RealType value = 0;
-			for (SizeType k=0;k<n;k++) {
-				value += PsimagLite::conj(engine.eigenvector(i,k))*engine.eigenvector(j,k)*
-						fermi(beta*(engine.eigenvalue(k)-mu));
-				if (i == j && i == 0) {
-					density += fermi(beta*(engine.eigenvalue(k)-mu));
-					energy += engine.eigenvalue(k)*fermi(beta*(engine.eigenvalue(k)-mu));
-				}
-			}
-			std::cout<<value<<" ";
-			if (i == j) ni[i] = value;
+
+	engine.thermal(points);
+
+	for (SizeType p=0;p<points.size();p++) {
+		const MatrixType& cicj = points[p].correlations;
+		std::cout<<"#beta="<<points[p].beta<<" mu="<<mu<<"\n";
+		for (SizeType i=0;i<n;i++) {
+			for (SizeType j=0;j<n;j++)
+				std::cout<<cicj(j,i)<<" ";
+			std::cout<<"\n";
 		}
-		std::cout<<"\n";
-	}
 
-	RealType sum1 = 0.0;
-	RealType sum2 = 0.0;
-	std::cout<<"#density = "<<density<<"\n";
-	for (SizeType i=0;i<ni.size();i++) {
-		std::cout<<i<<" "<<ni[i]<<"\n";
-		if (i<ni.size()/2) {
-			sum1 += ni[i];
-		} else {
-			sum2 += ni[i];
+		RealType sum1 = 0.0;
+		RealType sum2 = 0.0;
+		std::cout<<"#density = "<<points[p].density<<"\n";
+		for (SizeType i=0;i<n;i++) {
+			std::cout<<i<<" "<<cicj(i,i)<<"\n";
+			if (i<n/2) {
+				sum1 += cicj(i,i);
+			} else {
+				sum2 += cicj(i,i);
+			}
 		}
-	}
 
-	std::cout<<"#total density= "<<sum1<<" "<<sum2<<" "<<(sum1+sum2)<<"\n";
-	std::cout<<"#energy= "<<energy<<"\n";
+		std::cout<<"#total density= "<<sum1<<" "<<sum2<<" "<<(sum1+sum2)<<"\n";
+		std::cout<<"#energy= "<<points[p].energy<<"\n";
+	}
 }
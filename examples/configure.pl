@@ -36,7 +36,8 @@ $args{"configFiles"} = \@configFiles;
 my @drivers = ("cicj","deltaIdeltaJ","EasyExciton","HolonDoublon","decay",
 	       "reducedDensityMatrix","cicjBetaGrand",
 	       "dynamics","hd2","ninj","niVsBetaGrand","splusSminus","szsz",
-               "SzSzTime","etd","sqOmega","WavePacket", "WavePacket2");
+               "SzSzTime","etd","sqOmega","WavePacket", "WavePacket2",
+               "wickVsEnumeration");
 
 createMakefile(\@drivers, \%args);
 
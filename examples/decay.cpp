@@ -86,7 +86,8 @@ int main(int argc,char *argv[])
 	EngineType engine(geometry.matrix(),
 	                  geometryParams.outputFile,
 	                  dof,
-	                  EngineType::VerboseEnum::YES);
+	                  EngineType::VerboseEnum::YES,
+	                  geometryParams.engineOptions);
 	PsimagLite::Vector<SizeType>::Type ne(dof,electronsUp);
 	bool debug = false;
 	bool verbose = false;
@@ -108,7 +109,8 @@ int main(int argc,char *argv[])
 	EngineType engine2(geometry2.matrix(),
 	                   geometryParams.outputFile,
 	                   dof,
-	                   EngineType::VerboseEnum::YES);
+	                   EngineType::VerboseEnum::YES,
+	                   geometryParams.engineOptions);
 
 
 	typedef PsimagLite::Parallelizer<ParallelDecayType> ParallelizerType;
@@ -68,7 +68,8 @@ int main(int argc,char* argv[])
 	EngineType engine(geometry.matrix(),
 	                  geometryParams.outputFile,
 	                  dof,
-	                  EngineType::VerboseEnum::YES);
+	                  EngineType::VerboseEnum::YES,
+	                  geometryParams.engineOptions);
 	PsimagLite::Vector<SizeType>::Type ne(dof,electronsUp);
 	HilbertStateType gs(engine,ne);
 	RealType sum = 0;
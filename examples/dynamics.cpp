@@ -140,7 +140,8 @@ int main(int argc,char *argv[])
 	EngineType engine(geometry.matrix(),
 	                  geometryParams.outputFile,
 	                  dof,
-	                  EngineType::VerboseEnum::YES);
+	                  EngineType::VerboseEnum::YES,
+	                  geometryParams.engineOptions);
 
 	PsimagLite::Vector<SizeType>::Type ne(dof,electronsUp); // 8 up and 8 down
 	bool debug = false;
@@ -174,19 +175,25 @@ int main(int argc,char *argv[])
 	std::cout<<"#site="<<sites[0]<<"\n";
 	std::cout<<"#site2="<<sites[1]<<"\n";
 
+	if (total == 0) return 0;
+
 	RealType epsilon = 1e-2;
+	PsimagLite::Vector<RealType>::Type omegas(total);
+	for (SizeType it = 0; it<total; it++)
+		omegas[it] = it * step + offset;
+
+	OpDiagonalFactoryType opDiagonalFactory(engine);
+	int sign = (dynType== DYN_TYPE_1) ? -1 : 1;
+	OneOverZminusHType eih(omegas,epsilon,sign,Eg,engine);
+	DiagonalOperatorType& eihOp = opDiagonalFactory(eih);
+	HilbertStateType phi3 = phiKet;
+	eihOp.applyTo(phi3);
+	PsimagLite::Vector<FieldType>::Type values;
+	scalarProduct(values,phiBra,phi3);
+
 	for (SizeType it = 0; it<total; it++) {
-		OpDiagonalFactoryType opDiagonalFactory(engine);
-		RealType omega = it * step + offset;
-		ComplexType z = ComplexType(omega,epsilon);
-		int sign = (dynType== DYN_TYPE_1) ? -1 : 1;
-		OneOverZminusHType eih(z,sign,Eg,engine);
-		DiagonalOperatorType& eihOp = opDiagonalFactory(eih);
-		HilbertStateType phi3 = phiKet;
-		eihOp.applyTo(phi3);
-		FieldType tmpC = scalarProduct(phiBra,phi3);
-
-		std::cout<<omega<<" "<<PsimagLite::imag(tmpC)<<" "<<PsimagLite::real(tmpC)<<"\n";
+		FieldType tmpC = values[it];
+		std::cout<<omegas[it]<<" "<<PsimagLite::imag(tmpC)<<" "<<PsimagLite::real(tmpC)<<"\n";
 	}
 }
 
@@ -89,7 +89,8 @@ int main(int argc,char *argv[])
 	EngineType engine(geometry.matrix(),
 	                  geometryParams.outputFile,
 	                  dof,
-	                  EngineType::VerboseEnum::YES);
+	                  EngineType::VerboseEnum::YES,
+	                  geometryParams.engineOptions);
 
 	PsimagLite::Vector<SizeType>::Type ne(dof,electronsUp);
 	bool debug = false;
@@ -99,6 +100,35 @@ int main(int argc,char *argv[])
 
 	std::cout<<"#site="<<sites[0]<<"\n";
 	std::cout<<"#site2="<<sites[1]<<"\n";
+	if (geometryParams.omega == 0 && total > 0) {
+		// the Hamiltonian does not depend on time, so one grid of
+		// times and one enumeration serve all time steps
+		RealType arg = geometryParams.phase;
+		geometry.addPotentialT(arg);
+		EngineType engine2(geometry.matrix(),
+		                   geometryParams.outputFile,
+		                   dof,
+		                   EngineType::VerboseEnum::YES,
+		                   geometryParams.engineOptions);
+		PsimagLite::Vector<RealType>::Type times(total);
+		for (SizeType it = 0; it<total; it++)
+			times[it] = it * step + offset;
+
+		OpDiagonalFactoryType opDiagonalFactory(engine2);
+		OpLibFactoryType opLibFactory(engine2);
+		EtoTheIhTimeType eih(times,engine2,0);
+		DiagonalOperatorType& eihOp = opDiagonalFactory(eih);
+		HilbertStateType phi2 = gs;
+		eihOp.applyTo(phi2);
+		LibraryOperatorType& myOp = opLibFactory(LibraryOperatorType::N, sites[0], 0);
+		myOp.applyTo(phi2);
+		PsimagLite::Vector<ComplexType>::Type values;
+		scalarProduct(values,gs,phi2);
+		for (SizeType it = 0; it<total; it++)
+			std::cout<<times[it]<<" "<<values[it]<<" "<<arg<<"\n";
+		return 0;
+	}
+
 	for (SizeType it = 0; it<total; it++) {
 		RealType time = it * step + offset;
 		RealType arg = geometryParams.omega*time + geometryParams.phase;
@@ -106,7 +136,8 @@ int main(int argc,char *argv[])
 		EngineType engine2(geometry.matrix(),
 		                   geometryParams.outputFile,
 		                   dof,
-		                   EngineType::VerboseEnum::YES);
+		                   EngineType::VerboseEnum::YES,
+		                   geometryParams.engineOptions);
 		OpDiagonalFactoryType opDiagonalFactory(engine2);
 		OpLibFactoryType opLibFactory(engine2);
 		EtoTheIhTimeType eih(time,engine2,0);
@@ -86,10 +86,13 @@ FieldType calcSuperDensity(SizeType site,
 	return sum;
 }
 
+// Tasks are blocks of consecutive times; each block is one grid of
+// EToTheIhTime, so that one enumeration serves all its times
 class MyLoop {
 
 	typedef PsimagLite::Concurrency ConcurrencyType;
 	typedef PsimagLite::Vector<ComplexType>::Type VectorComplexType;
+	typedef PsimagLite::Vector<RealType>::Type VectorRealType;
 
 	enum {SPIN_UP,SPIN_DOWN};
 
@@ -101,6 +104,7 @@ public:
 	       const HilbertStateType& gs,
 	       PsimagLite::Vector<SizeType>::Type& sites,
 	       SizeType total,
+	       SizeType blocks,
 	       bool verbose)
 	    : engine_(engine),
 	      step_(step),
@@ -108,10 +112,13 @@ public:
 	      gs_(gs),
 	      sites_(sites),
 	      data_(total),
+	      blockSize_((blocks > 0) ? (total + blocks - 1)/blocks : total),
 	      verbose_(verbose)
-	{}
+	{
+		if (blockSize_ == 0) blockSize_ = 1;
+	}
 
-	SizeType tasks() const { return data_.size(); }
+	SizeType tasks() const { return (data_.size() + blockSize_ - 1)/blockSize_; }
 
 	void doTask(SizeType taskNumber, SizeType)
 	{
@@ -119,8 +126,13 @@ public:
 		OpLibFactoryType opLibFactory(engine_);
 		OpDiagonalFactoryType opDiagonalFactory(engine_);
 
-		RealType time = taskNumber * step_ + offset_;
-		EtoTheIhTimeType eih(time,engine_,0);
+		SizeType start = taskNumber*blockSize_;
+		SizeType end = std::min(start + blockSize_,data_.size());
+		VectorRealType times(end - start);
+		for (SizeType it = start; it < end; ++it)
+			times[it - start] = it * step_ + offset_;
+
+		EtoTheIhTimeType eih(times,engine_,0);
 		DiagonalOperatorType& eihOp = opDiagonalFactory(eih);
 
 		PsimagLite::Vector<HilbertStateType*>::Type savedVector(4);
@@ -162,18 +174,21 @@ public:
 			}
 		}
 
-		FieldType sum = 0;
+		VectorComplexType sum(times.size(),0.0);
+		VectorComplexType values;
 		SizeType total = savedVector.size()*savedVector.size()/2;
 		for (SizeType x=0;x<total;x++) {
 			SizeType sigma = (x & 3);
 			SizeType sigma2 = (x & 12);
 			sigma2 >>= 2;
-			sum += scalarProduct(*savedVector[sigma],*savedVector[sigma2]);
+			scalarProduct(values,*savedVector[sigma],*savedVector[sigma2]);
+			for (SizeType k=0;k<sum.size();k++) sum[k] += values[k];
 		}
 
 		for (SizeType x=0;x<savedVector.size();x++) delete savedVector[x];
 
-		data_[taskNumber] = 2.0*sum;
+		for (SizeType it = start; it < end; ++it)
+			data_[it] = 2.0*sum[it - start];
 	}
 
 	void printTasks(std::ostream& os) const
@@ -193,6 +208,7 @@ private:
 	const HilbertStateType& gs_;
 	PsimagLite::Vector<SizeType>::Type& sites_;
 	VectorComplexType data_;
+	SizeType blockSize_;
 	bool verbose_;
 };
 
@@ -255,7 +271,8 @@ int main(int argc,char *argv[])
 	EngineType engine(geometry.matrix(),
 	                  geometryParams.outputFile,
 	                  dof,
-	                  EngineType::VerboseEnum::YES);
+	                  EngineType::VerboseEnum::YES,
+	                  geometryParams.engineOptions);
 
 	PsimagLite::Vector<SizeType>::Type ne(dof,electronsUp);
 	bool debug = false;
@@ -277,7 +294,14 @@ int main(int argc,char *argv[])
 	typedef PsimagLite::Parallelizer<MyLoopType> ParallelizerType;
 	ParallelizerType threadObject(PsimagLite::Concurrency::codeSectionParams);
 
-	MyLoopType myLoop(engine,step,offset,gs,sites,total,verbose);
+	MyLoopType myLoop(engine,
+	                  step,
+	                  offset,
+	                  gs,
+	                  sites,
+	                  total,
+	                  PsimagLite::Concurrency::codeSectionParams.npthreads,
+	                  verbose);
 
 	std::cout<<"Using "<<threadObject.name();
 	std::cout<<" with "<<PsimagLite::Concurrency::codeSectionParams.npthreads<<" threads.\n";
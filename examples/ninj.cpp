@@ -6,13 +6,12 @@
 #include "Engine.h"
 #include "GeometryLibrary.h"
 #include "TypeToString.h"
-#include "CreationOrDestructionOp.h"
-#include "HilbertState.h"
 #include "GeometryParameters.h"
-#include "LibraryOperator.h"
 #include "Concurrency.h"
 #include "InputNg.h"
 #include "InputCheck.h"
+#include "CorrelationMatrix.h"
+#include "WickFourPoint.h"
 
 typedef double RealType;
 typedef std::complex<double> ComplexType;
@@ -23,11 +22,8 @@ typedef PsimagLite::InputNg<FreeFermions::InputCheck> InputNgType;
 typedef FreeFermions::GeometryParameters<RealType,InputNgType::Readable> GeometryParamsType;
 typedef FreeFermions::GeometryLibrary<MatrixType,GeometryParamsType> GeometryLibraryType;
 typedef FreeFermions::Engine<RealType,FieldType> EngineType;
-typedef FreeFermions::CreationOrDestructionOp<EngineType> OperatorType;
-typedef FreeFermions::HilbertState<OperatorType> HilbertStateType;
-typedef OperatorType::FactoryType OpNormalFactoryType;
-typedef FreeFermions::LibraryOperator<OperatorType> LibraryOperatorType;
-typedef LibraryOperatorType::FactoryType OpLibFactoryType;
+typedef FreeFermions::CorrelationMatrix<EngineType> CorrelationMatrixType;
+typedef FreeFermions::WickFourPoint<FieldType> WickFourPointType;
 
 void usage(const PsimagLite::String& thisFile)
 {
@@ -73,9 +69,9 @@ int main(int argc,char* argv[])
 	EngineType engine(geometry.matrix(),
 	                  geometryParams.outputFile,
 	                  dof,
-	                  EngineType::VerboseEnum::YES);
+	                  EngineType::VerboseEnum::YES,
+	                  geometryParams.engineOptions);
 	PsimagLite::Vector<SizeType>::Type ne(dof,electronsUp);
-	HilbertStateType gs(engine,ne);
 	RealType sum = 0;
 	for (SizeType i=0;i<ne[0];i++) sum += engine.eigenvalue(i);
 	std::cerr<<"Energy="<<dof*sum<<"\n";
@@ -84,21 +80,14 @@ int main(int argc,char* argv[])
 	SizeType norbs = 1;
     io.readline(norbs, "Orbitals=");
 	SizeType tot = geometryParams.sites;
+	CorrelationMatrixType correlations(engine,ne);
+	WickFourPointType wick(correlations(sigma));
+	MatrixType ninj;
+	wick.densityDensity(ninj);
 	for (SizeType orbital = 0; orbital < norbs; ++orbital) {
 		for (SizeType site = 0; site<tot ; site++) {
-			OpLibFactoryType opLibFactory(engine);
-			LibraryOperatorType& myOp = opLibFactory(LibraryOperatorType::N,
-			                                         site + orbital*tot,
-				                                     sigma);
-			for (SizeType site2=0; site2<tot; site2++) {
-				HilbertStateType phi = gs;
-				myOp.applyTo(phi);
-				LibraryOperatorType& myOp2 = opLibFactory(LibraryOperatorType::N,
-				                                          site2 + orbital*tot,
-				                                          sigma);
-				myOp2.applyTo(phi);
-				std::cout<<scalarProduct(gs,phi)<<" ";
-			}
+			for (SizeType site2=0; site2<tot; site2++)
+				std::cout<<ninj(site2 + orbital*tot,site + orbital*tot)<<" ";
 
 			std::cout<<"\n";
 		}
@@ -1,20 +1,15 @@
 // SAmple of how to use FreeFermions core engine to calculate
 // <A_i 1/(z-H) A_j>
 #include <cstdlib>
-#define USE_PTHREADS_OR_NOT_NG
 #include "Engine.h"
 #include "GeometryLibrary.h"
 #include "TypeToString.h"
-#include "CreationOrDestructionOp.h"
-#include "HilbertState.h"
-#include "OneOverZminusH.h"
-#include "DiagonalOperator.h"
 #include "GeometryParameters.h"
 #include "Concurrency.h"
 #include "InputNg.h"
 #include "InputCheck.h"
-#include "LibraryOperator.h"
-#include "Parallelizer.h"
+#include "ParticleHoleSpectrum.h"
+#include "Parallelizer2.h"
 
 typedef double RealType;
 typedef std::complex<double> ComplexType;
@@ -27,15 +22,9 @@ GeometryParamsType;
 typedef FreeFermions::GeometryLibrary<MatrixType,GeometryParamsType>
 GeometryLibraryType;
 typedef FreeFermions::Engine<RealType,FieldType> EngineType;
-typedef FreeFermions::CreationOrDestructionOp<EngineType> OperatorType;
-typedef FreeFermions::OneOverZminusH<EngineType> OneOverZminusHType;
-typedef FreeFermions::DiagonalOperator<OneOverZminusHType> DiagonalOperatorType;
-typedef FreeFermions::HilbertState<OperatorType,DiagonalOperatorType> HilbertStateType;
-typedef DiagonalOperatorType::FactoryType OpDiagonalFactoryType;
-typedef OperatorType::FactoryType OpNormalFactoryType;
-typedef FreeFermions::LibraryOperator<OperatorType> LibraryOperatorType;
-typedef LibraryOperatorType::FactoryType OpLibFactoryType;
 typedef PsimagLite::Matrix<ComplexType> MatrixComplexType;
+typedef FreeFermions::ParticleHoleSpectrum<EngineType> ParticleHoleSpectrumType;
+typedef PsimagLite::Parallelizer2<> ParallelizerType;
 
 enum ObservableEnum {OBS_SZ, OBS_C};
 
@@ -45,236 +34,80 @@ void usage(const PsimagLite::String& thisFile)
 	std::cout<<" -n sites -e electronsUp -g geometry,[leg,filename]\n";
 }
 
-struct SqOmegaParams {
-	SqOmegaParams(const EngineType& engine_,
-	              const HilbertStateType& gs_,
-	              RealType Eg_,
-	              SizeType sites_,
-	              SizeType centralSite_,
-	              ObservableEnum what_)
-	    : engine(engine_),
-	      gs(gs_),
-	      Eg(Eg_),
-	      sites(sites_),
-	      centralSite(centralSite_),
-	      observable(what_)
-	{}
-
-	const EngineType& engine;
-	const HilbertStateType& gs;
-	RealType Eg;
-	SizeType sites;
-	SizeType centralSite;
-	ObservableEnum observable;
-}; // struct SqOmegaParams
-
-class DynamicObservable {
-
-public:
-
-	DynamicObservable(ObservableEnum what,
-	                  const EngineType& engine)
-	    : what_(what),opLibFactory_(engine),opNormalFactory_(engine)
-	{}
-
-	void applyRightOperator(HilbertStateType& phiKet,
-	                        SizeType site0,
-	                        SizeType sigma0,
-	                        SizeType dynType,
-	                        SizeType threadNum)
-	{
-		if (what_ == OBS_SZ) {
-			LibraryOperatorType& nOpI = opLibFactory_(LibraryOperatorType::N,
-			                                          site0,
-			                                          sigma0,
-			                                          threadNum);
-			nOpI.applyTo(phiKet);
-			return;
-		}
-
-		assert(what_ == OBS_C);
-
-		if (dynType == 0) {
-			OperatorType& nOpI =  opNormalFactory_(LibraryOperatorType::CREATION,
-			                                       site0,
-			                                       sigma0,
-			                                       threadNum);
-			nOpI.applyTo(phiKet);
-			return;
-		}
-
-		assert(dynType == 1);
-		OperatorType& nOpI =  opNormalFactory_(LibraryOperatorType::DESTRUCTION,
-		                                       site0,
-		                                       sigma0,
-		                                       threadNum);
-		nOpI.applyTo(phiKet);
-	}
-
-	void applyLeftOperator(HilbertStateType& phiKet,
-	                       SizeType site0,
-	                       SizeType sigma0,
-	                       SizeType dynType,
-	                       SizeType threadNum)
-	{
-		if (what_ == OBS_SZ) {
-			LibraryOperatorType& nOpI = opLibFactory_(LibraryOperatorType::N,
-			                                          site0,
-			                                          sigma0,
-			                                          threadNum);
-			nOpI.applyTo(phiKet);
-			return;
-		}
-
-		assert(what_ == OBS_C);
-
-		if (dynType == 0) {
-			OperatorType& nOpI =  opNormalFactory_(LibraryOperatorType::CREATION,
-			                                       site0,
-			                                       sigma0,
-			                                       threadNum);
-			nOpI.applyTo(phiKet);
-			return;
-		}
-
-		assert(dynType == 1);
-		OperatorType& nOpI =  opNormalFactory_(LibraryOperatorType::DESTRUCTION,
-		                                       site0,
-		                                       sigma0,
-		                                       threadNum);
-		nOpI.applyTo(phiKet);
-	}
-
-	RealType signForWeight(SizeType sigma0,
-	                       SizeType sigma1,
-	                       SizeType dynType)
-	{
-		RealType sign = (sigma0 == sigma1) ? 1.0 : -1.0;
-		sign *= (dynType == 0) ? 1 : -1;
-		return (what_ == OBS_SZ) ? sign : -1.0;
-	}
-
-private:
-
-	ObservableEnum what_;
-	OpLibFactoryType opLibFactory_;
-	OpNormalFactoryType opNormalFactory_;
-}; // class DynamicObservable
-
-class SqOmegaParallel {
-
-public:
-
-	SqOmegaParallel(const SqOmegaParams& params,
-	                RealType total,
-	                RealType step,
-	                RealType offset)
-	    : params_(params),
-	      step_(step),
-	      offset_(offset),
-	      observable_(params.observable,params.engine),
-	      result_(total,params.sites),
-	      phiKet0_(params_.gs),
-	      phiKet1_(params_.gs)
-	{
-		SizeType site0 = params_.centralSite;
-		observable_.applyRightOperator(phiKet0_,
-		                               site0,
-		                               0,
-		                               0,
-		                               0);
-		observable_.applyRightOperator(phiKet1_,
-		                               site0,
-		                               0,
-		                               1,
-		                               0);
-	}
-
-	void doTask(SizeType taskNumber,SizeType threadNum)
-	{
-		RealType omega = taskNumber*step_ + offset_;
-		doOneOmega(taskNumber,omega, threadNum);
-	}
-
-	SizeType tasks() const { return result_.n_row(); }
-
-	void print(std::ostream& os) const
-	{
-		for (SizeType it = 0; it< result_.n_row(); it++) {
-			RealType omega = it * step_ + offset_;
-			os<<omega<<" ";
-			for (SizeType site1 = 0; site1 < result_.n_col(); ++site1) {
-				ComplexType val = result_(it,site1);
-				os<<PsimagLite::real(val)<<" "<<PsimagLite::imag(val)<<" ";
-			}
-
-			os<<"\n";
-		}
-	}
-
-private:
-
-	FieldType doOneOmegaOneSitePair(SizeType site1,
-	                                SizeType threadNum,
-	                                const HilbertStateType& phiKet0,
-	                                const HilbertStateType& phiKet1)
-	{
-		FieldType tmpC = 0.0;
-		SizeType sigma0 = 0;
-		SizeType sigma1 = 0;
-		for (SizeType dynType = 0; dynType < 2; ++dynType) {
-			RealType sign = observable_.signForWeight(sigma0, sigma1, dynType);
-
-			const HilbertStateType& phiKet = (dynType == 0) ? phiKet0 : phiKet1;
-
-			HilbertStateType phiBra = params_.gs;
-			observable_.applyLeftOperator(phiBra,
-			                              site1,
-			                              sigma1,
-			                              dynType,
-			                              threadNum);
-
-			tmpC += sign*scalarProduct(phiBra, phiKet);
+// one line per omega, real and imaginary parts for each site
+void printResult(const MatrixComplexType& result,RealType step,RealType offset)
+{
+	for (SizeType it = 0; it < result.n_row(); it++) {
+		RealType omega = it * step + offset;
+		std::cout<<omega<<" ";
+		for (SizeType site1 = 0; site1 < result.n_col(); ++site1) {
+			ComplexType val = result(it,site1);
+			std::cout<<PsimagLite::real(val)<<" "<<PsimagLite::imag(val)<<" ";
 		}
 
-		return tmpC;
+		std::cout<<"\n";
 	}
+}
 
-	void doOneOmega(SizeType it, RealType omega, SizeType threadNum)
+// -<c_site1 1/(z - H + Eg) c^dagger_c> - <c^dagger_site1 1/(z + H - Eg) c_c>
+// for each site1. The hopping matrix is real, so this is G(c,site1;-z),
+// row c of the Engine's Green's function, O(sites^2) per omega;
+// omegas are split among threads
+void sqOmegaGreensFunction(const EngineType& engine,
+                           SizeType sites,
+                           SizeType centralSite,
+                           SizeType total,
+                           RealType step,
+                           RealType offset)
+{
+	RealType epsilon = 0.1;
+	MatrixComplexType result(total,sites);
+	const EngineType::GreensFunctionCacheType& cache = engine.greensFunctionCache();
+	ParallelizerType parallelizer(PsimagLite::Concurrency::codeSectionParams);
+	parallelizer.parallelFor(0,total,[&result,&cache,sites,centralSite,step,offset,epsilon](SizeType it,SizeType)
 	{
-		HilbertStateType phiKet0 = phiKet0_;
-		HilbertStateType phiKet1 = phiKet1_;
-		RealType epsilon = 0.1;
-		ComplexType z = ComplexType(omega, epsilon);
-		OpDiagonalFactoryType opDiagonalFactory(params_.engine);
-		for (SizeType dynType = 0; dynType < 2; ++dynType) {
-
-			RealType signForDen = (dynType == 1) ? -1.0 : 1.0;
-			OneOverZminusHType eih(z, signForDen, params_.Eg, params_.engine);
-			DiagonalOperatorType& eihOp = opDiagonalFactory(eih);
-			if (dynType == 0)
-				eihOp.applyTo(phiKet0);
-			else
-				eihOp.applyTo(phiKet1);
-		}
+		RealType omega = it * step + offset;
+		EngineType::GreensFunctionCacheType::VectorComplexType row;
+		cache.frequencyRow(row,centralSite,ComplexType(-omega, -epsilon));
+		for (SizeType site1 = 0; site1 < sites; ++site1)
+			result(it,site1) = row[site1];
+	});
+
+	printResult(result,step,offset);
+}
 
-		for (SizeType site1 = 0; site1 < params_.sites; ++site1) {
-			result_(it, site1) = doOneOmegaOneSitePair(site1,
-			                                          threadNum,
-			                                          phiKet0,
-			                                          phiKet1);
-			std::cerr<<"site1="<<site1<<" "<<result_(it, site1)<<"\n";
-		}
+// From the particle-hole pairs, minus
+// <n_site1 1/(z - H + Eg) n_c> - <n_site1 1/(z + H - Eg) n_c>
+// for each site1
+void sqOmegaParticleHole(const EngineType& engine,
+                         SizeType ne,
+                         SizeType sites,
+                         SizeType centralSite,
+                         SizeType total,
+                         RealType step,
+                         RealType offset)
+{
+	RealType epsilon = 0.1;
+	ParticleHoleSpectrumType::OmegaGridType grid(total,
+	                                             offset,
+	                                             step,
+	                                             ParticleHoleSpectrumType::KernelEnum::RESOLVENT,
+	                                             epsilon);
+	ParticleHoleSpectrumType particleHole(engine,ne);
+	ParticleHoleSpectrumType::VectorComplexType central;
+	ParticleHoleSpectrumType::VectorComplexType amplitudes;
+	ParticleHoleSpectrumType::VectorComplexType values;
+	particleHole.siteAmplitudes(central,centralSite);
+	MatrixComplexType result(total,sites);
+	for (SizeType site1 = 0; site1 < sites; ++site1) {
+		particleHole.siteAmplitudes(amplitudes,site1);
+		particleHole.spectrum(values,amplitudes,central,grid,true);
+		for (SizeType it = 0; it < total; ++it)
+			result(it,site1) = -values[it];
 	}
 
-	const SqOmegaParams& params_;
-	RealType step_;
-	RealType offset_;
-	DynamicObservable observable_;
-	MatrixComplexType result_;
-	HilbertStateType phiKet0_;
-	HilbertStateType phiKet1_;
-};
+	printResult(result,step,offset);
+}
 
 int main(int argc,char *argv[])
 {
@@ -341,10 +174,9 @@ int main(int argc,char *argv[])
 	EngineType engine(geometry.matrix(),
 	                  geometryParams.outputFile,
 	                  dof,
-	                  EngineType::VerboseEnum::YES);
+	                  EngineType::VerboseEnum::YES,
+	                  geometryParams.engineOptions);
 	PsimagLite::Vector<SizeType>::Type ne(dof,electronsUp);
-	bool debug = false;
-	HilbertStateType gs(engine,ne,debug);
 
 	RealType Eg = 0;
 	for (SizeType i=0;i<ne[0];i++) Eg += engine.eigenvalue(i);
@@ -360,13 +192,11 @@ int main(int argc,char *argv[])
 	std::cout<<"#What="<<what<<"\n";
 	std::cout<<"#############\n";
 
-	typedef PsimagLite::Parallelizer<SqOmegaParallel> ParallelizerType;
-	ParallelizerType threadObject(PsimagLite::Concurrency::codeSectionParams);
-
-	SqOmegaParams params(engine,gs,Eg,geometryParams.sites,centralSite,what);
-	SqOmegaParallel helperSqOmega(params,total,step,offset);
-
-	threadObject.loopCreate(helperSqOmega);
+	// density and spin spectra are sums over particle-hole pairs
+	if (what == OBS_SZ) {
+		sqOmegaParticleHole(engine,ne[0],geometryParams.sites,centralSite,total,step,offset);
+		return 0;
+	}
 
-	helperSqOmega.print(std::cout);
+	sqOmegaGreensFunction(engine,geometryParams.sites,centralSite,total,step,offset);
 }
@@ -0,0 +1,159 @@
+// Checks that the two backends of HilbertState, ENUMERATION and WICK,
+// give the same matrix elements, including time evolution and
+// bra and ket with different fillings. See TestSuite/inputs
+#include <cstdlib>
+#include "Engine.h"
+#include "GeometryLibrary.h"
+#include "TypeToString.h"
+#include "CreationOrDestructionOp.h"
+#include "HilbertState.h"
+#include "EtoTheIhTime.h"
+#include "DiagonalOperator.h"
+#include "GeometryParameters.h"
+#include "Concurrency.h"
+#include "InputNg.h"
+#include "InputCheck.h"
+
+typedef double RealType;
+typedef std::complex<double> ComplexType;
+typedef ComplexType FieldType;
+typedef PsimagLite::Concurrency ConcurrencyType;
+typedef PsimagLite::Matrix<RealType> MatrixType;
+typedef PsimagLite::InputNg<FreeFermions::InputCheck> InputNgType;
+typedef FreeFermions::GeometryParameters<RealType,InputNgType::Readable> GeometryParamsType;
+typedef FreeFermions::GeometryLibrary<MatrixType,GeometryParamsType> GeometryLibraryType;
+typedef FreeFermions::Engine<RealType,FieldType> EngineType;
+typedef FreeFermions::CreationOrDestructionOp<EngineType> OperatorType;
+typedef FreeFermions::EToTheIhTime<EngineType> EtoTheIhTimeType;
+typedef FreeFermions::DiagonalOperator<EtoTheIhTimeType> DiagonalOperatorType;
+typedef FreeFermions::HilbertState<OperatorType,DiagonalOperatorType> HilbertStateType;
+typedef DiagonalOperatorType::FactoryType OpDiagonalFactoryType;
+typedef OperatorType::FactoryType OpNormalFactoryType;
+
+enum {SPIN_UP,SPIN_DOWN};
+
+// prints <bra|ket> with both backends and returns their difference
+RealType compare(const PsimagLite::String& label,
+                 HilbertStateType bra,
+                 HilbertStateType ket)
+{
+	bra.setBackend(HilbertStateType::BackendEnum::ENUMERATION);
+	ket.setBackend(HilbertStateType::BackendEnum::ENUMERATION);
+	ComplexType value = scalarProduct(bra,ket);
+
+	bra.setBackend(HilbertStateType::BackendEnum::WICK);
+	ket.setBackend(HilbertStateType::BackendEnum::WICK);
+	ComplexType value2 = scalarProduct(bra,ket);
+
+	std::cout<<label<<" "<<value<<" "<<value2<<"\n";
+	return std::abs(value - value2);
+}
+
+int main(int argc,char* argv[])
+{
+	int opt = 0;
+	PsimagLite::String file("");
+	RealType time = 0;
+	RealType tolerance = 1e-8;
+
+	while ((opt = getopt(argc, argv, "f:t:e:")) != -1) {
+		switch (opt) {
+		case 'f':
+			file=optarg;
+			break;
+		case 't':
+			time = atof(optarg);
+			break;
+		case 'e':
+			tolerance = atof(optarg);
+			break;
+		default: /* '?' */
+			err("Wrong usage\n");
+		}
+	}
+
+	if (file == "")
+		err("Wrong usage\n");
+
+	FreeFermions::InputCheck inputCheck;
+	InputNgType::Writeable ioWriteable(file,inputCheck);
+	InputNgType::Readable io(ioWriteable);
+
+	GeometryParamsType geometryParams(io);
+	SizeType electronsUp = GeometryParamsType::readElectrons(io,
+	                                                         geometryParams.sites);
+
+	SizeType dof = 2; // spin up and down
+
+	GeometryLibraryType geometry(geometryParams);
+
+	SizeType npthreads = 1;
+	ConcurrencyType concurrency(&argc,&argv,npthreads);
+	EngineType engine(geometry.matrix(),
+	                  geometryParams.outputFile,
+	                  dof,
+	                  EngineType::VerboseEnum::NO,
+	                  geometryParams.engineOptions);
+
+	PsimagLite::Vector<SizeType>::Type ne(dof,electronsUp);
+	HilbertStateType gs(engine,ne);
+	PsimagLite::Vector<SizeType>::Type nePlusOne = ne;
+	nePlusOne[SPIN_UP]++;
+	HilbertStateType above(engine,nePlusOne);
+
+	OpNormalFactoryType opNormalFactory(engine);
+	OpDiagonalFactoryType opDiagonalFactory(engine);
+	EtoTheIhTimeType eih(time,engine,0);
+	DiagonalOperatorType& eihOp = opDiagonalFactory(eih);
+
+	SizeType n = geometryParams.sites;
+	RealType maxDiff = 0;
+	std::cout<<"#time="<<time<<"\n";
+	std::cout<<"#label site site2 enumeration wick\n";
+	for (SizeType site = 0; site < n; site++) {
+		for (SizeType site2 = 0; site2 < n; site2++) {
+			OperatorType& cUp = opNormalFactory(OperatorType::DESTRUCTION,site,SPIN_UP);
+			OperatorType& cUp2 = opNormalFactory(OperatorType::DESTRUCTION,site2,SPIN_UP);
+			OperatorType& cdaggerUp = opNormalFactory(OperatorType::CREATION,site,SPIN_UP);
+			OperatorType& cdaggerUp2 = opNormalFactory(OperatorType::CREATION,site2,SPIN_UP);
+			OperatorType& cDown2 = opNormalFactory(OperatorType::DESTRUCTION,site2,SPIN_DOWN);
+			OperatorType& cdaggerDown2 = opNormalFactory(OperatorType::CREATION,site2,SPIN_DOWN);
+			PsimagLite::String sites = ttos(site) + " " + ttos(site2);
+
+			// <c^dagger_site c_site2>
+			HilbertStateType bra = gs;
+			cUp.applyTo(bra);
+			HilbertStateType ket = gs;
+			cUp2.applyTo(ket);
+			maxDiff = std::max(maxDiff,compare("cdaggerc " + sites,bra,ket));
+
+			// <c_site e^{iHt} c^dagger_site2>
+			bra = gs;
+			cdaggerUp.applyTo(bra);
+			ket = gs;
+			cdaggerUp2.applyTo(ket);
+			eihOp.applyTo(ket);
+			maxDiff = std::max(maxDiff,compare("ceihtcdagger " + sites,bra,ket));
+
+			// <n_site,up e^{iHt} n_site2,down>
+			ket = gs;
+			cDown2.applyTo(ket);
+			cdaggerDown2.applyTo(ket);
+			eihOp.applyTo(ket);
+			cUp.applyTo(ket);
+			cdaggerUp.applyTo(ket);
+			maxDiff = std::max(maxDiff,compare("nupeihtndown " + sites,gs,ket));
+
+			// <ne+1| c^dagger_site2 |ne>, zero because fillings differ
+			ket = gs;
+			cdaggerUp2.applyTo(ket);
+			maxDiff = std::max(maxDiff,compare("fillings " + sites,above,ket));
+		}
+	}
+
+	std::cout<<"#maxDiff="<<maxDiff<<"\n";
+	if (maxDiff <= tolerance) return 0;
+
+	PsimagLite::String str("wickVsEnumeration: backends differ by ");
+	throw PsimagLite::RuntimeError(str + ttos(maxDiff) + "\n");
+}
@@ -0,0 +1,190 @@
+// BEGIN LICENSE BLOCK
+/*
+Copyright (c) 2009-2021, UT-Battelle, LLC
+All rights reserved
+
+[FreeFermions, Version 1.0.0]
+[by G.A., Oak Ridge National Laboratory]
+
+UT Battelle Open Source Software License 11242008
+
+OPEN SOURCE LICENSE
+
+Subject to the conditions of this License, each
+contributor to this software hereby grants, free of
+charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), a
+perpetual, worldwide, non-exclusive, no-charge,
+royalty-free, irrevocable copyright license to use, copy,
+modify, merge, publish, distribute, and/or sublicense
+copies of the Software.
+
+1. Redistributions of Software must retain the above
+copyright and license notices, this list of conditions,
+and the following disclaimer.  Changes or modifications
+to, or derivative works of, the Software should be noted
+with comments and the contributor and organization's
+name.
+
+2. Neither the names of UT-Battelle, LLC or the
+Department of Energy nor the names of the Software
+contributors may be used to endorse or promote products
+derived from this software without specific prior written
+permission of UT-Battelle.
+
+3. The software and the end-user documentation included
+with the redistribution, with or without modification,
+must include the following acknowledgment:
+
+"This product includes software produced by UT-Battelle,
+LLC under Contract No. DE-AC05-00OR22725  with the
+Department of Energy."
+
+*********************************************************
+DISCLAIMER
+
+THE SOFTWARE IS SUPPLIED BY THE COPYRIGHT HOLDERS AND
+CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER, CONTRIBUTORS, UNITED STATES GOVERNMENT,
+OR THE UNITED STATES DEPARTMENT OF ENERGY BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+
+NEITHER THE UNITED STATES GOVERNMENT, NOR THE UNITED
+STATES DEPARTMENT OF ENERGY, NOR THE COPYRIGHT OWNER, NOR
+ANY OF THEIR EMPLOYEES, REPRESENTS THAT THE USE OF ANY
+INFORMATION, DATA, APPARATUS, PRODUCT, OR PROCESS
+DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+
+*********************************************************
+
+
+*/
+// END LICENSE BLOCK
+/** \ingroup DMRG */
+/*@{*/
+
+/*! \file CorrelationMatrix.h
+ *
+ * Equal-time <c^dagger_i c_j> of the ground state, all pairs at once
+ *
+ * With the ne lowest levels of a flavor occupied,
+ * C(i,j) = sum_{lambda<ne} U(i,lambda) U*(j,lambda),
+ * that is C = W W^dagger with W = U(:,0:ne), one GEMM instead of a
+ * Wick evaluation per pair. With orbitals > 1 the sites are numbered
+ * orbital by orbital, and only the diagonal orbital blocks are built,
+ * one GEMM each on the rows of W of that orbital.
+ * Flavors with the same filling share their matrices.
+ *
+ */
+#ifndef CORRELATION_MATRIX_H
+#define CORRELATION_MATRIX_H
+
+#include "Complex.h" // in PsimagLite
+#include "Matrix.h" // in PsimagLite
+#include "Vector.h" // in PsimagLite
+#include "BLAS.h" // in PsimagLite
+#include <algorithm>
+
+namespace FreeFermions {
+
+template<typename EngineType>
+class CorrelationMatrix {
+
+public:
+
+	typedef typename EngineType::RealType RealType;
+	typedef typename EngineType::FieldType FieldType;
+	typedef PsimagLite::Matrix<FieldType> MatrixType;
+	typedef typename PsimagLite::Vector<SizeType>::Type VectorSizeType;
+
+	// ne[sigma] electrons of flavor sigma
+	CorrelationMatrix(const EngineType& engine,
+	                  const VectorSizeType& ne,
+	                  SizeType orbitals = 1)
+	    : orbitals_(orbitals),
+	      sites_((orbitals > 0) ? engine.size()/orbitals : 0),
+	      fillingOf_(ne.size())
+	{
+		SizeType n = engine.size();
+		if (orbitals_ == 0 || sites_*orbitals_ != n)
+			throw PsimagLite::RuntimeError("CorrelationMatrix: sites not divisible by orbitals\n");
+
+		VectorSizeType fillings;
+		for (SizeType sigma=0;sigma<ne.size();sigma++) {
+			if (ne[sigma] > n)
+				throw PsimagLite::RuntimeError("CorrelationMatrix: more electrons than levels\n");
+			typename VectorSizeType::iterator it = std::find(fillings.begin(),
+			                                                 fillings.end(),
+			                                                 ne[sigma]);
+			fillingOf_[sigma] = it - fillings.begin();
+			if (it == fillings.end()) fillings.push_back(ne[sigma]);
+		}
+
+		matrices_.resize(fillings.size()*orbitals_);
+		for (SizeType f=0;f<fillings.size();f++)
+			compute(engine,fillings[f],f);
+	}
+
+	SizeType orbitals() const { return orbitals_; }
+
+	// sites per orbital, the size of each matrix
+	SizeType sites() const { return sites_; }
+
+	// C(i,j) = <c^dagger_i c_j> for flavor sigma, i and j in the given orbital
+	const MatrixType& operator()(SizeType sigma,SizeType orbital = 0) const
+	{
+		if (sigma >= fillingOf_.size() || orbital >= orbitals_)
+			throw PsimagLite::RuntimeError("CorrelationMatrix: no such flavor or orbital\n");
+		return matrices_[fillingOf_[sigma]*orbitals_ + orbital];
+	}
+
+private:
+
+	CorrelationMatrix(const CorrelationMatrix&)
+	{
+		throw PsimagLite::RuntimeError("Don't even think of coming here\n");
+	}
+
+	CorrelationMatrix& operator=(const CorrelationMatrix&);
+
+	void compute(const EngineType& engine,SizeType ne,SizeType f)
+	{
+		SizeType n = sites_;
+		for (SizeType orbital=0;orbital<orbitals_;orbital++) {
+			MatrixType& c = matrices_[f*orbitals_ + orbital];
+			c.resize(n,n);
+			if (ne == 0 || n == 0) continue;
+
+			SizeType offset = orbital*n;
+			MatrixType w(n,ne);
+			for (SizeType lambda=0;lambda<ne;lambda++)
+				for (SizeType i=0;i<n;i++)
+					w(i,lambda) = engine.eigenvector(i + offset,lambda);
+
+			FieldType one = 1.0;
+			FieldType zero = 0.0;
+			psimag::BLAS::GEMM('N','C',n,n,ne,one,&(w(0,0)),n,&(w(0,0)),n,
+			                   zero,&(c(0,0)),n);
+		}
+	}
+
+	SizeType orbitals_;
+	SizeType sites_;
+	VectorSizeType fillingOf_;
+	typename PsimagLite::Vector<MatrixType>::Type matrices_;
+}; // CorrelationMatrix
+} // namespace FreeFermions
+
+/*@}*/
+#endif // CORRELATION_MATRIX_H
@@ -106,6 +106,8 @@ public:
 
 	SizeType index() const { return ind_; }
 
+	const EngineType& engine() const { return engine_; }
+
 	FieldType const operator()(SizeType j) const
 	{
 		if (type_==CREATION) return engine_.eigenvector(ind_,j);
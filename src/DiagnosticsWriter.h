@@ -0,0 +1,399 @@
+// BEGIN LICENSE BLOCK
+/*
+Copyright (c) 2009-2021, UT-Battelle, LLC
+All rights reserved
+
+[FreeFermions, Version 1.0.0]
+[by G.A., Oak Ridge National Laboratory]
+
+UT Battelle Open Source Software License 11242008
+
+OPEN SOURCE LICENSE
+
+Subject to the conditions of this License, each
+contributor to this software hereby grants, free of
+charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), a
+perpetual, worldwide, non-exclusive, no-charge,
+royalty-free, irrevocable copyright license to use, copy,
+modify, merge, publish, distribute, and/or sublicense
+copies of the Software.
+
+1. Redistributions of Software must retain the above
+copyright and license notices, this list of conditions,
+and the following disclaimer.  Changes or modifications
+to, or derivative works of, the Software should be noted
+with comments and the contributor and organization's
+name.
+
+2. Neither the names of UT-Battelle, LLC or the
+Department of Energy nor the names of the Software
+contributors may be used to endorse or promote products
+derived from this software without specific prior written
+permission of UT-Battelle.
+
+3. The software and the end-user documentation included
+with the redistribution, with or without modification,
+must include the following acknowledgment:
+
+"This product includes software produced by UT-Battelle,
+LLC under Contract No. DE-AC05-00OR22725  with the
+Department of Energy."
+
+*********************************************************
+DISCLAIMER
+
+THE SOFTWARE IS SUPPLIED BY THE COPYRIGHT HOLDERS AND
+CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER, CONTRIBUTORS, UNITED STATES GOVERNMENT,
+OR THE UNITED STATES DEPARTMENT OF ENERGY BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+
+NEITHER THE UNITED STATES GOVERNMENT, NOR THE UNITED
+STATES DEPARTMENT OF ENERGY, NOR THE COPYRIGHT OWNER, NOR
+ANY OF THEIR EMPLOYEES, REPRESENTS THAT THE USE OF ANY
+INFORMATION, DATA, APPARATUS, PRODUCT, OR PROCESS
+DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+
+*********************************************************
+
+
+*/
+// END LICENSE BLOCK
+/** \ingroup DMRG */
+/*@{*/
+
+/*! \file DiagnosticsWriter.h
+ *
+ * Diagnostics output of Engine and GeometryLibrary
+ *
+ * Small lines go through operator<<, vectors and matrices through
+ * write(); everything is queued and formatted by a worker thread, in
+ * order. The thread is started by the first write, so a writer that
+ * is never written to costs nothing. The Diagnostics= token of
+ * EngineOptions picks the format of vectors and matrices:
+ * Summary (default) as one line with sizes and norms;
+ * Text as every element, in the output file;
+ * Binary as records in outputFile.bin, see writeRecord();
+ * Compressed as Binary with each record deflated by zlib, if compiled
+ * with USE_ZLIB.
+ *
+ */
+#ifndef DIAGNOSTICS_WRITER_H
+#define DIAGNOSTICS_WRITER_H
+
+#include "Complex.h" // in PsimagLite
+#include "Matrix.h" // in PsimagLite
+#include "Vector.h" // in PsimagLite
+#include "EngineOptions.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace FreeFermions {
+
+enum class DiagnosticsEnum {TEXT, BINARY, COMPRESSED, SUMMARY};
+
+class DiagnosticsWriter {
+
+	typedef std::function<void ()> TaskType;
+
+public:
+
+	typedef std::shared_ptr<DiagnosticsWriter> PointerType;
+
+	static DiagnosticsEnum fromOptions(const EngineOptions& options)
+	{
+		PsimagLite::String value;
+		if (!options.value(value,"Diagnostics")) return DiagnosticsEnum::SUMMARY;
+
+		if (value == "Text") return DiagnosticsEnum::TEXT;
+		if (value == "Binary") return DiagnosticsEnum::BINARY;
+		if (value == "Compressed") return DiagnosticsEnum::COMPRESSED;
+		if (value == "Summary") return DiagnosticsEnum::SUMMARY;
+		throw PsimagLite::RuntimeError("Diagnostics=" + value + " unknown\n");
+	}
+
+	// One writer per file, shared while any owner is alive, so that
+	// GeometryLibrary and Engine writing to the same file stay in order;
+	// the first owner decides mode and append
+	static PointerType open(PsimagLite::String filename,
+	                        DiagnosticsEnum mode,
+	                        bool append)
+	{
+		static std::mutex mutex;
+		static std::map<PsimagLite::String, std::weak_ptr<DiagnosticsWriter> > writers;
+
+		std::lock_guard<std::mutex> guard(mutex);
+		PointerType writer = writers[filename].lock();
+		if (writer) return writer;
+
+		writer.reset(new DiagnosticsWriter(filename,mode,append));
+		writers[filename] = writer;
+		return writer;
+	}
+
+	~DiagnosticsWriter()
+	{
+		flush();
+		{
+			std::lock_guard<std::mutex> guard(mutex_);
+			done_ = true;
+		}
+
+		wake_.notify_one();
+		if (worker_.joinable()) worker_.join();
+	}
+
+	DiagnosticsEnum mode() const { return mode_; }
+
+	// appends to the current line, which is queued by write() or flush()
+	template<typename T>
+	DiagnosticsWriter& operator<<(const T& x)
+	{
+		pending_<<x;
+		return *this;
+	}
+
+	// VectorType has size() and operator[]
+	template<typename VectorType>
+	void write(PsimagLite::String label,const VectorType& v)
+	{
+		typedef typename VectorType::value_type ValueType;
+		std::shared_ptr<VectorType> copy(new VectorType(v));
+		queuePending();
+		DiagnosticsWriter* self = this;
+		enqueue([self,label,copy]()
+		{
+			const VectorType& w = *copy;
+			if (self->mode_ == DiagnosticsEnum::TEXT) {
+				self->text_<<label<<"\n"<<w;
+				return;
+			}
+
+			if (self->mode_ == DiagnosticsEnum::SUMMARY) {
+				self->summary(label,w.size(),1,(w.size() > 0) ? &(w[0]) : 0);
+				return;
+			}
+
+			self->writeRecord<ValueType>(label,w.size(),1,(w.size() > 0) ? &(w[0]) : 0);
+		});
+	}
+
+	template<typename T>
+	void write(PsimagLite::String label,const PsimagLite::Matrix<T>& m)
+	{
+		std::shared_ptr<const PsimagLite::Matrix<T> > copy(new PsimagLite::Matrix<T>(m));
+		writeMatrix(label,copy.get(),copy);
+	}
+
+	// Same as write() without a copy of m, for large matrices; the
+	// caller keeps m alive and unchanged until the next flush()
+	template<typename T>
+	void writeNoCopy(PsimagLite::String label,const PsimagLite::Matrix<T>& m)
+	{
+		writeMatrix(label,&m,std::shared_ptr<const void>());
+	}
+
+	// waits until everything queued so far is on disk
+	void flush()
+	{
+		queuePending();
+		std::unique_lock<std::mutex> lock(mutex_);
+		idle_.wait(lock,[this]() { return tasks_.empty() && !busy_; });
+		text_.flush();
+		binary_.flush();
+	}
+
+private:
+
+	DiagnosticsWriter(PsimagLite::String filename,DiagnosticsEnum mode,bool append)
+	    : filename_(filename),
+	      mode_(mode),
+	      text_(filename.c_str(),(append) ? std::ios::app : std::ios::out),
+	      records_(0),
+	      busy_(false),
+	      done_(false)
+	{
+#ifndef USE_ZLIB
+		if (mode_ == DiagnosticsEnum::COMPRESSED) {
+			std::cerr<<"DiagnosticsWriter: compiled without USE_ZLIB, ";
+			std::cerr<<"writing Binary instead of Compressed\n";
+			mode_ = DiagnosticsEnum::BINARY;
+		}
+#endif
+	}
+
+	DiagnosticsWriter(const DiagnosticsWriter&)
+	{
+		throw PsimagLite::RuntimeError("Don't even think of coming here\n");
+	}
+
+	DiagnosticsWriter& operator=(const DiagnosticsWriter&);
+
+	// owner, if any, keeps *m alive until the task has run
+	template<typename T>
+	void writeMatrix(PsimagLite::String label,
+	                 const PsimagLite::Matrix<T>* m,
+	                 std::shared_ptr<const void> owner)
+	{
+		queuePending();
+		DiagnosticsWriter* self = this;
+		enqueue([self,label,m,owner]()
+		{
+			const PsimagLite::Matrix<T>& w = *m;
+			SizeType total = w.n_row()*w.n_col();
+			if (self->mode_ == DiagnosticsEnum::TEXT) {
+				self->text_<<label<<"\n"<<w;
+				return;
+			}
+
+			if (self->mode_ == DiagnosticsEnum::SUMMARY) {
+				self->summary(label,w.n_row(),w.n_col(),(total > 0) ? &(w(0,0)) : 0);
+				return;
+			}
+
+			self->writeRecord<T>(label,w.n_row(),w.n_col(),(total > 0) ? &(w(0,0)) : 0);
+		});
+	}
+
+	void queuePending()
+	{
+		PsimagLite::String str = pending_.str();
+		if (str.length() == 0) return;
+		pending_.str("");
+		DiagnosticsWriter* self = this;
+		enqueue([self,str]() { self->text_<<str; });
+	}
+
+	void enqueue(const TaskType& task)
+	{
+		{
+			std::lock_guard<std::mutex> guard(mutex_);
+			tasks_.push_back(task);
+			if (!worker_.joinable())
+				worker_ = std::thread([this]() { run(); });
+		}
+
+		wake_.notify_one();
+	}
+
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (true) {
+			wake_.wait(lock,[this]() { return done_ || !tasks_.empty(); });
+			if (tasks_.empty()) return;
+			TaskType task = tasks_.front();
+			tasks_.pop_front();
+			busy_ = true;
+			lock.unlock();
+			task();
+			lock.lock();
+			busy_ = false;
+			if (tasks_.empty()) idle_.notify_all();
+		}
+	}
+
+	template<typename T>
+	void summary(PsimagLite::String label,SizeType rows,SizeType cols,const T* data)
+	{
+		SizeType total = rows*cols;
+		double norm2 = 0;
+		for (SizeType i=0;i<total;i++) norm2 += std::norm(data[i]);
+		text_<<"#Summary "<<label<<" rows "<<rows<<" cols "<<cols;
+		text_<<" norm "<<sqrt(norm2);
+		if (total > 0) text_<<" first "<<data[0]<<" last "<<data[total - 1];
+		text_<<"\n";
+	}
+
+	// Binary file: "FFDIAG01", then per record
+	// uint32 label length, label, uint32 flags (1 complex, 2 deflated),
+	// uint32 bytes of a real number, uint64 rows, uint64 cols,
+	// uint64 payload bytes, payload (column major);
+	// the text file gets a line pointing to the record
+	template<typename T>
+	void writeRecord(PsimagLite::String label,SizeType rows,SizeType cols,const T* data)
+	{
+		typedef typename PsimagLite::Real<T>::Type RealType;
+		if (!binary_.is_open()) {
+			PsimagLite::String name = filename_ + ".bin";
+			binary_.open(name.c_str(),std::ios::binary | std::ios::out);
+			binary_.write("FFDIAG01",8);
+		}
+
+		const char* payload = reinterpret_cast<const char*>(data);
+		uint64_t payloadBytes = rows*cols*sizeof(T);
+		uint32_t flags = (PsimagLite::IsComplexNumber<T>::True) ? 1 : 0;
+#ifdef USE_ZLIB
+		typename PsimagLite::Vector<unsigned char>::Type deflated;
+		if (mode_ == DiagnosticsEnum::COMPRESSED && payloadBytes > 0) {
+			uLongf size = compressBound(payloadBytes);
+			deflated.resize(size);
+			int ret = compress2(&(deflated[0]),&size,
+			                    reinterpret_cast<const Bytef*>(payload),
+			                    payloadBytes,Z_BEST_SPEED);
+			if (ret == Z_OK) {
+				flags |= 2;
+				payload = reinterpret_cast<const char*>(&(deflated[0]));
+				payloadBytes = size;
+			}
+		}
+#endif
+
+		uint32_t labelLength = label.length();
+		uint32_t realBytes = sizeof(RealType);
+		uint64_t r = rows;
+		uint64_t c = cols;
+		binary_.write(reinterpret_cast<const char*>(&labelLength),sizeof(labelLength));
+		binary_.write(label.c_str(),labelLength);
+		binary_.write(reinterpret_cast<const char*>(&flags),sizeof(flags));
+		binary_.write(reinterpret_cast<const char*>(&realBytes),sizeof(realBytes));
+		binary_.write(reinterpret_cast<const char*>(&r),sizeof(r));
+		binary_.write(reinterpret_cast<const char*>(&c),sizeof(c));
+		binary_.write(reinterpret_cast<const char*>(&payloadBytes),sizeof(payloadBytes));
+		binary_.write(payload,payloadBytes);
+
+		text_<<"#Binary "<<label<<" record "<<records_++<<" of "<<filename_<<".bin\n";
+	}
+
+	PsimagLite::String filename_;
+	DiagnosticsEnum mode_;
+	std::ofstream text_;
+	std::ofstream binary_;
+	SizeType records_;
+	std::ostringstream pending_;
+	std::deque<TaskType> tasks_;
+	bool busy_;
+	bool done_;
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::condition_variable idle_;
+	std::thread worker_;
+}; // DiagnosticsWriter
+} // namespace FreeFermions
+
+/*@}*/
+#endif // DIAGNOSTICS_WRITER_H
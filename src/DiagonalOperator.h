@@ -101,6 +101,22 @@ public:
 		return backend_(freeOps,loc);
 	}
 
+	SizeType gridSize() const { return backend_.gridSize(); }
+
+	template<typename FreeOperatorsType>
+	void operator()(typename PsimagLite::Vector<FieldType>::Type& values,
+	                const FreeOperatorsType& freeOps,
+	                SizeType loc) const
+	{
+		backend_(values,freeOps,loc);
+	}
+
+	template<typename FreeOperatorsType>
+	FieldType weight(SizeType type, SizeType lambda) const
+	{
+		return backend_.template weight<FreeOperatorsType>(type, lambda);
+	}
+
 	void transpose() { backend_.transpose(); }
 
 	template<typename SomeStateType>
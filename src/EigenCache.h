@@ -0,0 +1,294 @@
+// BEGIN LICENSE BLOCK
+/*
+Copyright (c) 2009-2021, UT-Battelle, LLC
+All rights reserved
+
+[FreeFermions, Version 1.0.0]
+[by G.A., Oak Ridge National Laboratory]
+
+UT Battelle Open Source Software License 11242008
+
+OPEN SOURCE LICENSE
+
+Subject to the conditions of this License, each
+contributor to this software hereby grants, free of
+charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), a
+perpetual, worldwide, non-exclusive, no-charge,
+royalty-free, irrevocable copyright license to use, copy,
+modify, merge, publish, distribute, and/or sublicense
+copies of the Software.
+
+1. Redistributions of Software must retain the above
+copyright and license notices, this list of conditions,
+and the following disclaimer.  Changes or modifications
+to, or derivative works of, the Software should be noted
+with comments and the contributor and organization's
+name.
+
+2. Neither the names of UT-Battelle, LLC or the
+Department of Energy nor the names of the Software
+contributors may be used to endorse or promote products
+derived from this software without specific prior written
+permission of UT-Battelle.
+
+3. The software and the end-user documentation included
+with the redistribution, with or without modification,
+must include the following acknowledgment:
+
+"This product includes software produced by UT-Battelle,
+LLC under Contract No. DE-AC05-00OR22725  with the
+Department of Energy."
+
+*********************************************************
+DISCLAIMER
+
+THE SOFTWARE IS SUPPLIED BY THE COPYRIGHT HOLDERS AND
+CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER, CONTRIBUTORS, UNITED STATES GOVERNMENT,
+OR THE UNITED STATES DEPARTMENT OF ENERGY BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+
+NEITHER THE UNITED STATES GOVERNMENT, NOR THE UNITED
+STATES DEPARTMENT OF ENERGY, NOR THE COPYRIGHT OWNER, NOR
+ANY OF THEIR EMPLOYEES, REPRESENTS THAT THE USE OF ANY
+INFORMATION, DATA, APPARATUS, PRODUCT, OR PROCESS
+DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+
+*********************************************************
+
+
+*/
+// END LICENSE BLOCK
+/** \ingroup DMRG */
+/*@{*/
+
+/*! \file EigenCache.h
+ *
+ * On-disk cache of an Engine's eigenvalues and eigenvectors
+ *
+ * The file name carries a hash of the hopping matrix and of dof.
+ * The file is a fixed header followed by the hopping matrix, the
+ * eigenvalues and then the eigenvectors, column by column, all in
+ * native binary, so that loading maps the file and copies it out with
+ * two memcpy's. The hash only picks the file; it is used only if the
+ * matrix stored in it is the one asked for, bit by bit.
+ * The eigenvectors may be real for a complex FieldType, as Engine keeps
+ * them for a real hopping matrix; the header says which.
+ *
+ */
+#ifndef EIGEN_CACHE_H
+#define EIGEN_CACHE_H
+
+#include "Complex.h" // in PsimagLite
+#include "Matrix.h" // in PsimagLite
+#include "Vector.h" // in PsimagLite
+#include "EngineOptions.h"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace FreeFermions {
+
+template<typename RealType,typename FieldType>
+class EigenCache {
+
+	typedef PsimagLite::Matrix<FieldType> MatrixType;
+	typedef typename PsimagLite::Vector<RealType>::Type VectorRealType;
+
+	struct HeaderType {
+		char magic[8];
+		std::uint64_t n;
+		std::uint64_t dof;
+		std::uint64_t realSize;
+		std::uint64_t fieldSize;
+		std::uint64_t complexVectors;
+		std::uint64_t hash;
+	};
+
+public:
+
+	EigenCache(const MatrixType& m,SizeType dof,PsimagLite::String dir)
+	    : n_(m.n_row()),dof_(dof),hash_(hash(m,dof)),matrix_(m)
+	{
+		std::ostringstream name;
+		name<<dir<<"/FreeFermionsEigen"<<std::hex<<hash_<<".bin";
+		filename_ = name.str();
+	}
+
+	// options has EigenCache to use the current directory,
+	// or EigenCache=dir
+	static bool fromOptions(const EngineOptions& options,PsimagLite::String& dir)
+	{
+		if (!options.isSet("EigenCache")) return false;
+		if (!options.value(dir,"EigenCache")) dir = ".";
+		return true;
+	}
+
+	const PsimagLite::String& filename() const { return filename_; }
+
+	// VectorType is FieldType or RealType; false if the file has the
+	// other kind of eigenvectors
+	template<typename VectorType>
+	bool load(PsimagLite::Matrix<VectorType>& vectors,VectorRealType& values) const
+	{
+		int fd = open(filename_.c_str(),O_RDONLY);
+		if (fd < 0) return false;
+
+		struct stat st;
+		size_t bytes = totalBytes(sizeof(VectorType));
+		if (fstat(fd,&st) != 0 || static_cast<size_t>(st.st_size) != bytes) {
+			close(fd);
+			return false;
+		}
+
+		void* p = mmap(0,bytes,PROT_READ,MAP_PRIVATE,fd,0);
+		close(fd);
+		if (p == MAP_FAILED) return false;
+
+		const char* data = static_cast<const char*>(p);
+		HeaderType header;
+		memcpy(&header,data,sizeof(HeaderType));
+		data += sizeof(HeaderType);
+		bool ok = (sameHeader(header,isComplex<VectorType>()) && sameMatrix(data));
+		if (ok) {
+			values.resize(n_);
+			vectors.resize(n_,n_);
+			if (n_ > 0) {
+				data += n_*n_*sizeof(FieldType);
+				memcpy(&(values[0]),data,n_*sizeof(RealType));
+				data += n_*sizeof(RealType);
+				memcpy(&(vectors(0,0)),data,n_*n_*sizeof(VectorType));
+			}
+		}
+
+		munmap(p,bytes);
+		return ok;
+	}
+
+	// Writes to a temporary file first, so that a concurrent run never
+	// sees half a file; failures only warn, the cache being optional
+	template<typename VectorType>
+	void save(const PsimagLite::Matrix<VectorType>& vectors,const VectorRealType& values) const
+	{
+		std::ostringstream tmp;
+		tmp<<filename_<<".tmp"<<getpid();
+		PsimagLite::String tmpName = tmp.str();
+		HeaderType header = makeHeader(isComplex<VectorType>());
+		std::ofstream fout(tmpName.c_str(),std::ios::binary);
+		fout.write(reinterpret_cast<const char*>(&header),sizeof(HeaderType));
+		if (n_ > 0) {
+			fout.write(reinterpret_cast<const char*>(&(matrix_(0,0))),
+			           n_*n_*sizeof(FieldType));
+			fout.write(reinterpret_cast<const char*>(&(values[0])),n_*sizeof(RealType));
+			fout.write(reinterpret_cast<const char*>(&(vectors(0,0))),
+			           n_*n_*sizeof(VectorType));
+		}
+
+		fout.close();
+		if (!fout || rename(tmpName.c_str(),filename_.c_str()) != 0) {
+			std::cerr<<"EigenCache: WARNING: could not write "<<filename_<<"\n";
+			unlink(tmpName.c_str());
+		}
+	}
+
+private:
+
+	template<typename VectorType>
+	static bool isComplex()
+	{
+		return PsimagLite::IsComplexNumber<VectorType>::True;
+	}
+
+	size_t totalBytes(size_t vectorSize) const
+	{
+		return sizeof(HeaderType) + n_*sizeof(RealType) +
+		        n_*n_*(sizeof(FieldType) + vectorSize);
+	}
+
+	HeaderType makeHeader(bool complexVectors) const
+	{
+		HeaderType header;
+		memset(&header,0,sizeof(HeaderType));
+		memcpy(header.magic,"FFEIGEN2",8);
+		header.n = n_;
+		header.dof = dof_;
+		header.realSize = sizeof(RealType);
+		header.fieldSize = sizeof(FieldType);
+		header.complexVectors = (complexVectors) ? 1 : 0;
+		header.hash = hash_;
+		return header;
+	}
+
+	bool sameHeader(const HeaderType& header,bool complexVectors) const
+	{
+		HeaderType expected = makeHeader(complexVectors);
+		return (memcmp(header.magic,expected.magic,8) == 0 &&
+		        header.n == expected.n &&
+		        header.dof == expected.dof &&
+		        header.realSize == expected.realSize &&
+		        header.fieldSize == expected.fieldSize &&
+		        header.complexVectors == expected.complexVectors &&
+		        header.hash == expected.hash);
+	}
+
+	// the hopping matrix at data is matrix_
+	bool sameMatrix(const char* data) const
+	{
+		if (n_ == 0) return true;
+		return (memcmp(data,&(matrix_(0,0)),n_*n_*sizeof(FieldType)) == 0);
+	}
+
+	// FNV-1a over 64-bit words, then over the bytes left
+	static std::uint64_t hash(const MatrixType& m,SizeType dof)
+	{
+		const std::uint64_t prime = 1099511628211ULL;
+		std::uint64_t h = 14695981039346656037ULL;
+		std::uint64_t sizes[] = {m.n_row(),m.n_col(),dof,sizeof(FieldType)};
+		for (SizeType i=0;i<4;i++)
+			h = (h ^ sizes[i])*prime;
+
+		if (m.n_row() == 0 || m.n_col() == 0) return h;
+
+		const char* data = reinterpret_cast<const char*>(&(m(0,0)));
+		size_t bytes = m.n_row()*m.n_col()*sizeof(FieldType);
+		size_t words = bytes/sizeof(std::uint64_t);
+		for (size_t i=0;i<words;i++) {
+			std::uint64_t word;
+			memcpy(&word,data + i*sizeof(std::uint64_t),sizeof(std::uint64_t));
+			h = (h ^ word)*prime;
+		}
+
+		for (size_t i=words*sizeof(std::uint64_t);i<bytes;i++)
+			h = (h ^ static_cast<unsigned char>(data[i]))*prime;
+
+		return h;
+	}
+
+	SizeType n_;
+	SizeType dof_;
+	std::uint64_t hash_;
+	MatrixType matrix_;
+	PsimagLite::String filename_;
+}; // EigenCache
+} // namespace FreeFermions
+
+/*@}*/
+#endif // EIGEN_CACHE_H
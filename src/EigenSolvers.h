@@ -0,0 +1,788 @@
+// BEGIN LICENSE BLOCK
+/*
+Copyright (c) 2009-2021, UT-Battelle, LLC
+All rights reserved
+
+[FreeFermions, Version 1.0.0]
+[by G.A., Oak Ridge National Laboratory]
+
+UT Battelle Open Source Software License 11242008
+
+OPEN SOURCE LICENSE
+
+Subject to the conditions of this License, each
+contributor to this software hereby grants, free of
+charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), a
+perpetual, worldwide, non-exclusive, no-charge,
+royalty-free, irrevocable copyright license to use, copy,
+modify, merge, publish, distribute, and/or sublicense
+copies of the Software.
+
+1. Redistributions of Software must retain the above
+copyright and license notices, this list of conditions,
+and the following disclaimer.  Changes or modifications
+to, or derivative works of, the Software should be noted
+with comments and the contributor and organization's
+name.
+
+2. Neither the names of UT-Battelle, LLC or the
+Department of Energy nor the names of the Software
+contributors may be used to endorse or promote products
+derived from this software without specific prior written
+permission of UT-Battelle.
+
+3. The software and the end-user documentation included
+with the redistribution, with or without modification,
+must include the following acknowledgment:
+
+"This product includes software produced by UT-Battelle,
+LLC under Contract No. DE-AC05-00OR22725  with the
+Department of Energy."
+
+*********************************************************
+DISCLAIMER
+
+THE SOFTWARE IS SUPPLIED BY THE COPYRIGHT HOLDERS AND
+CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER, CONTRIBUTORS, UNITED STATES GOVERNMENT,
+OR THE UNITED STATES DEPARTMENT OF ENERGY BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+
+NEITHER THE UNITED STATES GOVERNMENT, NOR THE UNITED
+STATES DEPARTMENT OF ENERGY, NOR THE COPYRIGHT OWNER, NOR
+ANY OF THEIR EMPLOYEES, REPRESENTS THAT THE USE OF ANY
+INFORMATION, DATA, APPARATUS, PRODUCT, OR PROCESS
+DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+
+*********************************************************
+
+
+*/
+// END LICENSE BLOCK
+/** \ingroup DMRG */
+/*@{*/
+
+/*! \file EigenSolvers.h
+ *
+ * Hermitian (or real symmetric) eigensolvers for Engine
+ *
+ * DEFAULT is PsimagLite's diag(), DIVIDE_AND_CONQUER calls
+ * heevd/syevd and MRRR calls heevr/syevr; all return eigenvalues in
+ * ascending order and overwrite the matrix with the eigenvectors,
+ * one per column.
+ *
+ * banded() takes over when the matrix, in site order or folded as
+ * 0, n-1, 1, n-2, ..., has a narrow band: tridiagonal matrices go to
+ * stemr after a diagonal gauge makes them real, wider bands to
+ * hbevd/sbevd. Folding turns a periodic chain into a band of width 2.
+ *
+ * partial() computes only a range of eigenpairs, by index or by energy:
+ * one reduction to tridiagonal form (hetrd/sytrd), stemr on the range,
+ * and unmtr/ormtr to take the eigenvectors back.
+ *
+ */
+#ifndef EIGEN_SOLVERS_H
+#define EIGEN_SOLVERS_H
+
+#include "Complex.h" // in PsimagLite
+#include "Matrix.h" // in PsimagLite
+#include "Vector.h" // in PsimagLite
+#include "TypeToString.h" // in PsimagLite
+#include "EngineOptions.h"
+#include <algorithm>
+#include <cstdlib>
+
+extern "C" {
+void ssyevd_(char*,char*,int*,float*,int*,float*,float*,int*,int*,int*,int*);
+void dsyevd_(char*,char*,int*,double*,int*,double*,double*,int*,int*,int*,int*);
+void cheevd_(char*,char*,int*,std::complex<float>*,int*,float*,
+             std::complex<float>*,int*,float*,int*,int*,int*,int*);
+void zheevd_(char*,char*,int*,std::complex<double>*,int*,double*,
+             std::complex<double>*,int*,double*,int*,int*,int*,int*);
+
+void ssyevr_(char*,char*,char*,int*,float*,int*,float*,float*,int*,int*,
+             float*,int*,float*,float*,int*,int*,float*,int*,int*,int*,int*);
+void dsyevr_(char*,char*,char*,int*,double*,int*,double*,double*,int*,int*,
+             double*,int*,double*,double*,int*,int*,double*,int*,int*,int*,int*);
+void cheevr_(char*,char*,char*,int*,std::complex<float>*,int*,float*,float*,
+             int*,int*,float*,int*,float*,std::complex<float>*,int*,int*,
+             std::complex<float>*,int*,float*,int*,int*,int*,int*);
+void zheevr_(char*,char*,char*,int*,std::complex<double>*,int*,double*,double*,
+             int*,int*,double*,int*,double*,std::complex<double>*,int*,int*,
+             std::complex<double>*,int*,double*,int*,int*,int*,int*);
+
+void sstemr_(char*,char*,int*,float*,float*,float*,float*,int*,int*,int*,
+             float*,float*,int*,int*,int*,int*,float*,int*,int*,int*,int*);
+void dstemr_(char*,char*,int*,double*,double*,double*,double*,int*,int*,int*,
+             double*,double*,int*,int*,int*,int*,double*,int*,int*,int*,int*);
+
+void ssbevd_(char*,char*,int*,int*,float*,int*,float*,float*,int*,
+             float*,int*,int*,int*,int*);
+void dsbevd_(char*,char*,int*,int*,double*,int*,double*,double*,int*,
+             double*,int*,int*,int*,int*);
+void chbevd_(char*,char*,int*,int*,std::complex<float>*,int*,float*,
+             std::complex<float>*,int*,std::complex<float>*,int*,float*,int*,
+             int*,int*,int*);
+void zhbevd_(char*,char*,int*,int*,std::complex<double>*,int*,double*,
+             std::complex<double>*,int*,std::complex<double>*,int*,double*,int*,
+             int*,int*,int*);
+
+void ssytrd_(char*,int*,float*,int*,float*,float*,float*,float*,int*,int*);
+void dsytrd_(char*,int*,double*,int*,double*,double*,double*,double*,int*,int*);
+void chetrd_(char*,int*,std::complex<float>*,int*,float*,float*,
+             std::complex<float>*,std::complex<float>*,int*,int*);
+void zhetrd_(char*,int*,std::complex<double>*,int*,double*,double*,
+             std::complex<double>*,std::complex<double>*,int*,int*);
+
+void sormtr_(char*,char*,char*,int*,int*,float*,int*,float*,float*,int*,
+             float*,int*,int*);
+void dormtr_(char*,char*,char*,int*,int*,double*,int*,double*,double*,int*,
+             double*,int*,int*);
+void cunmtr_(char*,char*,char*,int*,int*,std::complex<float>*,int*,
+             std::complex<float>*,std::complex<float>*,int*,
+             std::complex<float>*,int*,int*);
+void zunmtr_(char*,char*,char*,int*,int*,std::complex<double>*,int*,
+             std::complex<double>*,std::complex<double>*,int*,
+             std::complex<double>*,int*,int*);
+}
+
+namespace FreeFermions {
+
+enum class EigenSolverEnum {DEFAULT, DIVIDE_AND_CONQUER, MRRR};
+
+template<typename FieldType>
+class EigenSolvers {
+
+	typedef typename PsimagLite::Real<FieldType>::Type RealType;
+	typedef PsimagLite::Matrix<FieldType> MatrixType;
+	typedef typename PsimagLite::Vector<RealType>::Type VectorRealType;
+	typedef typename PsimagLite::Vector<FieldType>::Type VectorFieldType;
+	typedef typename PsimagLite::Vector<int>::Type VectorIntType;
+	typedef typename PsimagLite::Vector<SizeType>::Type VectorSizeType;
+	typedef PsimagLite::Matrix<RealType> MatrixRealType;
+
+public:
+
+	// eigenpairs first,...,last-1 in ascending order, last == 0 meaning
+	// all from first on, or if byEnergy those in [low,high)
+	struct RangeType {
+
+		RangeType()
+		    : byEnergy(false), first(0), last(0), low(0), high(0)
+		{}
+
+		bool byEnergy;
+		SizeType first;
+		SizeType last;
+		RealType low;
+		RealType high;
+	};
+
+	// smaller matrices are left to the dense solvers
+	static const SizeType BAND_MIN_SIZE = 64;
+
+	// Levels=first:last or Window=low:high among comma-separated options
+	static bool rangeFromOptions(const EngineOptions& options,RangeType& range)
+	{
+		PsimagLite::String value;
+		bool byEnergy = false;
+		if (!options.value(value,"Levels")) {
+			if (!options.value(value,"Window")) return false;
+			byEnergy = true;
+		}
+
+		size_t colon = value.find(":");
+		if (colon == PsimagLite::String::npos)
+			throw PsimagLite::RuntimeError("EigenSolvers: expected a:b, not " + value + "\n");
+
+		PsimagLite::String a = value.substr(0,colon);
+		PsimagLite::String b = value.substr(colon + 1);
+		range.byEnergy = byEnergy;
+		if (byEnergy) {
+			range.low = atof(a.c_str());
+			range.high = atof(b.c_str());
+		} else {
+			range.first = atoi(a.c_str());
+			range.last = atoi(b.c_str());
+		}
+
+		return true;
+	}
+
+	// Computes only the eigenpairs in range, see RangeType;
+	// m becomes n x found, eigs has the found eigenvalues;
+	// returns the index of the first one found
+	static SizeType partial(MatrixType& m,VectorRealType& eigs,RangeType range)
+	{
+		int n = m.n_row();
+		if (n == 0 || m.n_row() != m.n_col())
+			throw PsimagLite::RuntimeError("EigenSolvers::partial(): empty or not square\n");
+
+		VectorSizeType order(n);
+		for (int k=0;k<n;k++) order[k] = k;
+		if (bandwidth(m,order) < 2) {
+			VectorRealType d(n);
+			VectorRealType e(n,0.0);
+			for (int k=0;k<n;k++) {
+				d[k] = PsimagLite::real(m(k,k));
+				if (k+1 < n) e[k] = std::abs(m(k,k+1));
+			}
+
+			toIndices(range,d,e);
+			tridiagonal(m,eigs,order,range);
+			return range.first;
+		}
+
+		char uplo = 'U';
+		int info = 0;
+		VectorRealType d(n);
+		VectorRealType e(n,0.0);
+		VectorFieldType tau(std::max(1,n-1));
+		int lwork = -1;
+		VectorFieldType work(1);
+		trd(&uplo,&n,&(m(0,0)),&n,&(d[0]),&(e[0]),&(tau[0]),&(work[0]),&lwork,&info);
+		check("hetrd/sytrd (query)",info);
+		lwork = static_cast<int>(PsimagLite::real(work[0]));
+		work.resize(lwork);
+		trd(&uplo,&n,&(m(0,0)),&n,&(d[0]),&(e[0]),&(tau[0]),&(work[0]),&lwork,&info);
+		check("hetrd/sytrd",info);
+
+		toIndices(range,d,e);
+		MatrixRealType z;
+		tridiagonalVectors(d,e,range.first,range.last,eigs,z);
+
+		int found = range.last - range.first;
+		MatrixType c(n,found);
+		for (int lambda=0;lambda<found;lambda++)
+			for (int i=0;i<n;i++)
+				c(i,lambda) = z(i,lambda);
+
+		char side = 'L';
+		char trans = 'N';
+		lwork = -1;
+		mtr(&side,&uplo,&trans,&n,&found,&(m(0,0)),&n,&(tau[0]),&(c(0,0)),&n,
+		    &(work[0]),&lwork,&info);
+		check("unmtr/ormtr (query)",info);
+		lwork = static_cast<int>(PsimagLite::real(work[0]));
+		work.resize(lwork);
+		mtr(&side,&uplo,&trans,&n,&found,&(m(0,0)),&n,&(tau[0]),&(c(0,0)),&n,
+		    &(work[0]),&lwork,&info);
+		check("unmtr/ormtr",info);
+
+		m = c;
+		return range.first;
+	}
+
+	static PsimagLite::String name(EigenSolverEnum solver)
+	{
+		switch (solver) {
+		case EigenSolverEnum::DIVIDE_AND_CONQUER:
+			return "DivideAndConquer";
+		case EigenSolverEnum::MRRR:
+			return "Mrrr";
+		default:
+			return "Default";
+		}
+	}
+
+	static void diagonalize(MatrixType& m,
+	                        VectorRealType& eigs,
+	                        EigenSolverEnum solver)
+	{
+		if (solver == EigenSolverEnum::DEFAULT || m.n_row() == 0) {
+			diag(m,eigs,'V');
+			return;
+		}
+
+		if (m.n_row() != m.n_col())
+			throw PsimagLite::RuntimeError("EigenSolvers: matrix not square\n");
+
+		if (solver == EigenSolverEnum::DIVIDE_AND_CONQUER)
+			divideAndConquer(m,eigs);
+		else
+			mrrr(m,eigs);
+	}
+
+	// Diagonalizes m as diagonalize() does if its bandwidth, in site
+	// order or folded, is below a quarter of its size;
+	// returns false and leaves m alone otherwise
+	static bool banded(MatrixType& m,VectorRealType& eigs)
+	{
+		SizeType n = m.n_row();
+		if (n < BAND_MIN_SIZE || n != m.n_col()) return false;
+
+		VectorSizeType order(n);
+		for (SizeType k=0;k<n;k++) order[k] = k;
+		SizeType kd = bandwidth(m,order);
+
+		VectorSizeType folded(n);
+		for (SizeType k=0;k<n;k++) folded[k] = (k & 1) ? n - 1 - k/2 : k/2;
+		SizeType kdFolded = bandwidth(m,folded);
+		if (kdFolded < kd) {
+			kd = kdFolded;
+			order.swap(folded);
+		}
+
+		if (4*kd >= n) return false;
+
+		if (kd < 2)
+			tridiagonal(m,eigs,order);
+		else
+			band(m,eigs,order,kd);
+		return true;
+	}
+
+private:
+
+	// max |k-l| over the non-zero m(order[k],order[l])
+	static SizeType bandwidth(const MatrixType& m,const VectorSizeType& order)
+	{
+		SizeType n = order.size();
+		SizeType kd = 0;
+		for (SizeType l=0;l<n;l++) {
+			for (SizeType k=0;k<l;k++) {
+				if (m(order[k],order[l]) == static_cast<RealType>(0)) continue;
+				kd = std::max(kd,l-k);
+				break;
+			}
+		}
+
+		return kd;
+	}
+
+	// With phase[k+1] = phase[k]*conj(t_k)/|t_k|, D^dagger m D is real
+	// symmetric with off-diagonal |t_k|, and m's eigenvectors are D times
+	// those of the real matrix; m becomes n x (last - first)
+	static void tridiagonal(MatrixType& m,
+	                        VectorRealType& eigs,
+	                        const VectorSizeType& order,
+	                        RangeType range = RangeType())
+	{
+		int n = order.size();
+		VectorRealType d(n);
+		VectorRealType e(n,0.0);
+		VectorFieldType phase(n,1.0);
+		for (int k=0;k<n;k++) {
+			d[k] = PsimagLite::real(m(order[k],order[k]));
+			if (k+1 == n) continue;
+			FieldType t = m(order[k],order[k+1]);
+			e[k] = std::abs(t);
+			phase[k+1] = (e[k] == 0) ? phase[k] : phase[k]*PsimagLite::conj(t)/e[k];
+		}
+
+		toIndices(range,d,e);
+		MatrixRealType z;
+		tridiagonalVectors(d,e,range.first,range.last,eigs,z);
+
+		SizeType found = range.last - range.first;
+		m.resize(n,found);
+		for (int k=0;k<n;k++)
+			for (SizeType lambda=0;lambda<found;lambda++)
+				m(order[k],lambda) = phase[k]*z(k,lambda);
+	}
+
+	// Eigenpairs first,...,last-1 of the symmetric tridiagonal matrix
+	// with diagonal d and off-diagonal e, by stemr;
+	// d and e are overwritten
+	static void tridiagonalVectors(VectorRealType& d,
+	                               VectorRealType& e,
+	                               SizeType first,
+	                               SizeType last,
+	                               VectorRealType& eigs,
+	                               MatrixRealType& z)
+	{
+		int n = d.size();
+		char jobz = 'V';
+		char range = (first == 0 && last == d.size()) ? 'A' : 'I';
+		RealType vl = 0;
+		RealType vu = 0;
+		int il = first + 1;
+		int iu = last;
+		int found = 0;
+		int nzc = last - first;
+		int tryrac = 1;
+		int info = 0;
+		eigs.resize(n);
+		z.resize(n,std::max(1,nzc));
+		VectorIntType isuppz(2*n);
+
+		// workspace query
+		int lwork = -1;
+		int liwork = -1;
+		VectorRealType work(1);
+		VectorIntType iwork(1);
+		stemr(&jobz,&range,&n,&(d[0]),&(e[0]),&vl,&vu,&il,&iu,&found,&(eigs[0]),
+		      &(z(0,0)),&n,&nzc,&(isuppz[0]),&tryrac,&(work[0]),&lwork,
+		      &(iwork[0]),&liwork,&info);
+		check("stemr (query)",info);
+
+		lwork = static_cast<int>(work[0]);
+		liwork = iwork[0];
+		work.resize(lwork);
+		iwork.resize(liwork);
+		stemr(&jobz,&range,&n,&(d[0]),&(e[0]),&vl,&vu,&il,&iu,&found,&(eigs[0]),
+		      &(z(0,0)),&n,&nzc,&(isuppz[0]),&tryrac,&(work[0]),&lwork,
+		      &(iwork[0]),&liwork,&info);
+		check("stemr",info);
+		if (found != nzc)
+			throw PsimagLite::RuntimeError("EigenSolvers: stemr missed eigenpairs\n");
+		eigs.resize(found);
+	}
+
+	// An energy window becomes the range of indices it holds, counted
+	// from all the eigenvalues of the tridiagonal matrix, O(n^2)
+	static void toIndices(RangeType& range,
+	                      const VectorRealType& d,
+	                      const VectorRealType& e)
+	{
+		SizeType n = d.size();
+		if (range.last == 0 && !range.byEnergy) range.last = n;
+		if (range.byEnergy) {
+			VectorRealType dd(d);
+			VectorRealType ee(e);
+			VectorRealType all(n);
+			char jobz = 'N';
+			char r = 'A';
+			int nn = n;
+			RealType vl = 0;
+			RealType vu = 0;
+			int il = 0;
+			int iu = 0;
+			int found = 0;
+			int nzc = 0;
+			int ldz = 1;
+			int tryrac = 0;
+			int info = 0;
+			RealType z = 0;
+			VectorIntType isuppz(2*n);
+			int lwork = 12*n;
+			int liwork = 8*n;
+			VectorRealType work(lwork);
+			VectorIntType iwork(liwork);
+			stemr(&jobz,&r,&nn,&(dd[0]),&(ee[0]),&vl,&vu,&il,&iu,&found,&(all[0]),
+			      &z,&ldz,&nzc,&(isuppz[0]),&tryrac,&(work[0]),&lwork,
+			      &(iwork[0]),&liwork,&info);
+			check("stemr (eigenvalues)",info);
+			all.resize(found);
+			range.first = std::lower_bound(all.begin(),all.end(),range.low) - all.begin();
+			range.last = std::lower_bound(all.begin(),all.end(),range.high) - all.begin();
+		}
+
+		if (range.last > n) range.last = n;
+		if (range.first >= range.last)
+			throw PsimagLite::RuntimeError("EigenSolvers: empty range of eigenpairs\n");
+	}
+
+	// LAPACK's upper band storage: ab(kd+k-l,l) = m(order[k],order[l])
+	static void band(MatrixType& m,VectorRealType& eigs,const VectorSizeType& order,int kd)
+	{
+		char jobz = 'V';
+		char uplo = 'U';
+		int n = order.size();
+		int ldab = kd + 1;
+		int info = 0;
+		VectorFieldType ab(ldab*n,0.0);
+		for (int l=0;l<n;l++)
+			for (int k=std::max(0,l-kd);k<=l;k++)
+				ab[kd+k-l+l*ldab] = m(order[k],order[l]);
+
+		eigs.resize(n);
+		MatrixType z(n,n);
+
+		// workspace query
+		int lwork = -1;
+		int lrwork = -1;
+		int liwork = -1;
+		VectorFieldType work(1);
+		VectorRealType rwork(1);
+		VectorIntType iwork(1);
+		bevd(&jobz,&uplo,&n,&kd,&(ab[0]),&ldab,&(eigs[0]),&(z(0,0)),&n,
+		     &(work[0]),&lwork,&(rwork[0]),&lrwork,&(iwork[0]),&liwork,&info);
+		check("hbevd/sbevd (query)",info);
+
+		lwork = static_cast<int>(PsimagLite::real(work[0]));
+		lrwork = std::max(1,static_cast<int>(rwork[0]));
+		liwork = iwork[0];
+		work.resize(lwork);
+		rwork.resize(lrwork);
+		iwork.resize(liwork);
+		bevd(&jobz,&uplo,&n,&kd,&(ab[0]),&ldab,&(eigs[0]),&(z(0,0)),&n,
+		     &(work[0]),&lwork,&(rwork[0]),&lrwork,&(iwork[0]),&liwork,&info);
+		check("hbevd/sbevd",info);
+
+		for (int k=0;k<n;k++)
+			for (int lambda=0;lambda<n;lambda++)
+				m(order[k],lambda) = z(k,lambda);
+	}
+
+	static void divideAndConquer(MatrixType& m,VectorRealType& eigs)
+	{
+		char jobz = 'V';
+		char uplo = 'U';
+		int n = m.n_row();
+		int info = 0;
+		eigs.resize(n);
+
+		// workspace query
+		int lwork = -1;
+		int lrwork = -1;
+		int liwork = -1;
+		VectorFieldType work(1);
+		VectorRealType rwork(1);
+		VectorIntType iwork(1);
+		evd(&jobz,&uplo,&n,&(m(0,0)),&n,&(eigs[0]),&(work[0]),&lwork,
+		    &(rwork[0]),&lrwork,&(iwork[0]),&liwork,&info);
+		check("heevd/syevd (query)",info);
+
+		lwork = static_cast<int>(PsimagLite::real(work[0]));
+		lrwork = std::max(1,static_cast<int>(rwork[0]));
+		liwork = iwork[0];
+		work.resize(lwork);
+		rwork.resize(lrwork);
+		iwork.resize(liwork);
+		evd(&jobz,&uplo,&n,&(m(0,0)),&n,&(eigs[0]),&(work[0]),&lwork,
+		    &(rwork[0]),&lrwork,&(iwork[0]),&liwork,&info);
+		check("heevd/syevd",info);
+	}
+
+	static void mrrr(MatrixType& m,VectorRealType& eigs)
+	{
+		char jobz = 'V';
+		char range = 'A';
+		char uplo = 'U';
+		int n = m.n_row();
+		RealType vl = 0;
+		RealType vu = 0;
+		int il = 0;
+		int iu = 0;
+		RealType abstol = 0;
+		int found = 0;
+		int info = 0;
+		eigs.resize(n);
+		MatrixType z(n,n);
+		VectorIntType isuppz(2*n);
+
+		// workspace query
+		int lwork = -1;
+		int lrwork = -1;
+		int liwork = -1;
+		VectorFieldType work(1);
+		VectorRealType rwork(1);
+		VectorIntType iwork(1);
+		evr(&jobz,&range,&uplo,&n,&(m(0,0)),&n,&vl,&vu,&il,&iu,&abstol,&found,
+		    &(eigs[0]),&(z(0,0)),&n,&(isuppz[0]),&(work[0]),&lwork,
+		    &(rwork[0]),&lrwork,&(iwork[0]),&liwork,&info);
+		check("heevr/syevr (query)",info);
+
+		lwork = static_cast<int>(PsimagLite::real(work[0]));
+		lrwork = std::max(1,static_cast<int>(rwork[0]));
+		liwork = iwork[0];
+		work.resize(lwork);
+		rwork.resize(lrwork);
+		iwork.resize(liwork);
+		evr(&jobz,&range,&uplo,&n,&(m(0,0)),&n,&vl,&vu,&il,&iu,&abstol,&found,
+		    &(eigs[0]),&(z(0,0)),&n,&(isuppz[0]),&(work[0]),&lwork,
+		    &(rwork[0]),&lrwork,&(iwork[0]),&liwork,&info);
+		check("heevr/syevr",info);
+		if (found != n)
+			throw PsimagLite::RuntimeError("EigenSolvers: heevr/syevr missed eigenpairs\n");
+
+		m = z;
+	}
+
+	static void check(PsimagLite::String what,int info)
+	{
+		if (info == 0) return;
+		PsimagLite::String str("EigenSolvers: " + what + " failed with info=");
+		throw PsimagLite::RuntimeError(str + ttos(info) + "\n");
+	}
+
+	// The real drivers take no rwork; it is left untouched
+	static void evd(char* jobz,char* uplo,int* n,float* a,int* lda,float* w,
+	                float* work,int* lwork,float*,int*,
+	                int* iwork,int* liwork,int* info)
+	{
+		ssyevd_(jobz,uplo,n,a,lda,w,work,lwork,iwork,liwork,info);
+	}
+
+	static void evd(char* jobz,char* uplo,int* n,double* a,int* lda,double* w,
+	                double* work,int* lwork,double*,int*,
+	                int* iwork,int* liwork,int* info)
+	{
+		dsyevd_(jobz,uplo,n,a,lda,w,work,lwork,iwork,liwork,info);
+	}
+
+	static void evd(char* jobz,char* uplo,int* n,std::complex<float>* a,int* lda,
+	                float* w,std::complex<float>* work,int* lwork,
+	                float* rwork,int* lrwork,int* iwork,int* liwork,int* info)
+	{
+		cheevd_(jobz,uplo,n,a,lda,w,work,lwork,rwork,lrwork,iwork,liwork,info);
+	}
+
+	static void evd(char* jobz,char* uplo,int* n,std::complex<double>* a,int* lda,
+	                double* w,std::complex<double>* work,int* lwork,
+	                double* rwork,int* lrwork,int* iwork,int* liwork,int* info)
+	{
+		zheevd_(jobz,uplo,n,a,lda,w,work,lwork,rwork,lrwork,iwork,liwork,info);
+	}
+
+	static void evr(char* jobz,char* range,char* uplo,int* n,float* a,int* lda,
+	                float* vl,float* vu,int* il,int* iu,float* abstol,int* m,
+	                float* w,float* z,int* ldz,int* isuppz,float* work,int* lwork,
+	                float*,int*,int* iwork,int* liwork,int* info)
+	{
+		ssyevr_(jobz,range,uplo,n,a,lda,vl,vu,il,iu,abstol,m,w,z,ldz,isuppz,
+		        work,lwork,iwork,liwork,info);
+	}
+
+	static void evr(char* jobz,char* range,char* uplo,int* n,double* a,int* lda,
+	                double* vl,double* vu,int* il,int* iu,double* abstol,int* m,
+	                double* w,double* z,int* ldz,int* isuppz,double* work,int* lwork,
+	                double*,int*,int* iwork,int* liwork,int* info)
+	{
+		dsyevr_(jobz,range,uplo,n,a,lda,vl,vu,il,iu,abstol,m,w,z,ldz,isuppz,
+		        work,lwork,iwork,liwork,info);
+	}
+
+	static void evr(char* jobz,char* range,char* uplo,int* n,std::complex<float>* a,
+	                int* lda,float* vl,float* vu,int* il,int* iu,float* abstol,
+	                int* m,float* w,std::complex<float>* z,int* ldz,int* isuppz,
+	                std::complex<float>* work,int* lwork,float* rwork,int* lrwork,
+	                int* iwork,int* liwork,int* info)
+	{
+		cheevr_(jobz,range,uplo,n,a,lda,vl,vu,il,iu,abstol,m,w,z,ldz,isuppz,
+		        work,lwork,rwork,lrwork,iwork,liwork,info);
+	}
+
+	static void evr(char* jobz,char* range,char* uplo,int* n,std::complex<double>* a,
+	                int* lda,double* vl,double* vu,int* il,int* iu,double* abstol,
+	                int* m,double* w,std::complex<double>* z,int* ldz,int* isuppz,
+	                std::complex<double>* work,int* lwork,double* rwork,int* lrwork,
+	                int* iwork,int* liwork,int* info)
+	{
+		zheevr_(jobz,range,uplo,n,a,lda,vl,vu,il,iu,abstol,m,w,z,ldz,isuppz,
+		        work,lwork,rwork,lrwork,iwork,liwork,info);
+	}
+
+	static void stemr(char* jobz,char* range,int* n,float* d,float* e,float* vl,
+	                  float* vu,int* il,int* iu,int* m,float* w,float* z,int* ldz,
+	                  int* nzc,int* isuppz,int* tryrac,float* work,int* lwork,
+	                  int* iwork,int* liwork,int* info)
+	{
+		sstemr_(jobz,range,n,d,e,vl,vu,il,iu,m,w,z,ldz,nzc,isuppz,tryrac,
+		        work,lwork,iwork,liwork,info);
+	}
+
+	static void stemr(char* jobz,char* range,int* n,double* d,double* e,double* vl,
+	                  double* vu,int* il,int* iu,int* m,double* w,double* z,int* ldz,
+	                  int* nzc,int* isuppz,int* tryrac,double* work,int* lwork,
+	                  int* iwork,int* liwork,int* info)
+	{
+		dstemr_(jobz,range,n,d,e,vl,vu,il,iu,m,w,z,ldz,nzc,isuppz,tryrac,
+		        work,lwork,iwork,liwork,info);
+	}
+
+	static void bevd(char* jobz,char* uplo,int* n,int* kd,float* ab,int* ldab,
+	                 float* w,float* z,int* ldz,float* work,int* lwork,float*,int*,
+	                 int* iwork,int* liwork,int* info)
+	{
+		ssbevd_(jobz,uplo,n,kd,ab,ldab,w,z,ldz,work,lwork,iwork,liwork,info);
+	}
+
+	static void bevd(char* jobz,char* uplo,int* n,int* kd,double* ab,int* ldab,
+	                 double* w,double* z,int* ldz,double* work,int* lwork,double*,int*,
+	                 int* iwork,int* liwork,int* info)
+	{
+		dsbevd_(jobz,uplo,n,kd,ab,ldab,w,z,ldz,work,lwork,iwork,liwork,info);
+	}
+
+	static void bevd(char* jobz,char* uplo,int* n,int* kd,std::complex<float>* ab,
+	                 int* ldab,float* w,std::complex<float>* z,int* ldz,
+	                 std::complex<float>* work,int* lwork,float* rwork,int* lrwork,
+	                 int* iwork,int* liwork,int* info)
+	{
+		chbevd_(jobz,uplo,n,kd,ab,ldab,w,z,ldz,work,lwork,rwork,lrwork,
+		        iwork,liwork,info);
+	}
+
+	static void bevd(char* jobz,char* uplo,int* n,int* kd,std::complex<double>* ab,
+	                 int* ldab,double* w,std::complex<double>* z,int* ldz,
+	                 std::complex<double>* work,int* lwork,double* rwork,int* lrwork,
+	                 int* iwork,int* liwork,int* info)
+	{
+		zhbevd_(jobz,uplo,n,kd,ab,ldab,w,z,ldz,work,lwork,rwork,lrwork,
+		        iwork,liwork,info);
+	}
+
+	static void trd(char* uplo,int* n,float* a,int* lda,float* d,float* e,
+	                float* tau,float* work,int* lwork,int* info)
+	{
+		ssytrd_(uplo,n,a,lda,d,e,tau,work,lwork,info);
+	}
+
+	static void trd(char* uplo,int* n,double* a,int* lda,double* d,double* e,
+	                double* tau,double* work,int* lwork,int* info)
+	{
+		dsytrd_(uplo,n,a,lda,d,e,tau,work,lwork,info);
+	}
+
+	static void trd(char* uplo,int* n,std::complex<float>* a,int* lda,float* d,
+	                float* e,std::complex<float>* tau,std::complex<float>* work,
+	                int* lwork,int* info)
+	{
+		chetrd_(uplo,n,a,lda,d,e,tau,work,lwork,info);
+	}
+
+	static void trd(char* uplo,int* n,std::complex<double>* a,int* lda,double* d,
+	                double* e,std::complex<double>* tau,std::complex<double>* work,
+	                int* lwork,int* info)
+	{
+		zhetrd_(uplo,n,a,lda,d,e,tau,work,lwork,info);
+	}
+
+	static void mtr(char* side,char* uplo,char* trans,int* m,int* n,float* a,
+	                int* lda,float* tau,float* c,int* ldc,float* work,int* lwork,
+	                int* info)
+	{
+		sormtr_(side,uplo,trans,m,n,a,lda,tau,c,ldc,work,lwork,info);
+	}
+
+	static void mtr(char* side,char* uplo,char* trans,int* m,int* n,double* a,
+	                int* lda,double* tau,double* c,int* ldc,double* work,int* lwork,
+	                int* info)
+	{
+		dormtr_(side,uplo,trans,m,n,a,lda,tau,c,ldc,work,lwork,info);
+	}
+
+	static void mtr(char* side,char* uplo,char* trans,int* m,int* n,
+	                std::complex<float>* a,int* lda,std::complex<float>* tau,
+	                std::complex<float>* c,int* ldc,std::complex<float>* work,
+	                int* lwork,int* info)
+	{
+		cunmtr_(side,uplo,trans,m,n,a,lda,tau,c,ldc,work,lwork,info);
+	}
+
+	static void mtr(char* side,char* uplo,char* trans,int* m,int* n,
+	                std::complex<double>* a,int* lda,std::complex<double>* tau,
+	                std::complex<double>* c,int* ldc,std::complex<double>* work,
+	                int* lwork,int* info)
+	{
+		zunmtr_(side,uplo,trans,m,n,a,lda,tau,c,ldc,work,lwork,info);
+	}
+}; // EigenSolvers
+} // namespace FreeFermions
+
+/*@}*/
+#endif // EIGEN_SOLVERS_H
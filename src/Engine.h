@@ -80,7 +80,18 @@ DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
 #define ENGINE_H
 #include "Matrix.h"
 #include "Vector.h"
+#include "BLAS.h"
+#include "GreensFunctionCache.h"
+#include "EigenSolvers.h"
+#include "EigenCache.h"
+#include "EngineOptions.h"
+#include "PlaneWaves.h"
+#include "DiagnosticsWriter.h"
+#include "Parallelizer2.h"
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <memory>
 
 namespace FreeFermions {
 // All interactions == 0
@@ -92,74 +103,729 @@ public:
 	typedef RealType_ RealType;
 	typedef FieldType_ FieldType;
 	typedef  PsimagLite::Matrix<FieldType> MatrixType;
+	typedef Engine<RealType_,FieldType_> ThisType;
+	typedef GreensFunctionCache<RealType,FieldType,ThisType> GreensFunctionCacheType;
+	typedef EigenSolvers<FieldType> EigenSolversType;
+	typedef EigenCache<RealType,FieldType> EigenCacheType;
+	typedef PlaneWaves<FieldType> PlaneWavesType;
 
 	enum class VerboseEnum {NO, YES};
 
+	// A grand-canonical point: beta and mu in, the rest filled by thermal()
+	struct ThermalPointType {
+
+		ThermalPointType(RealType b = 0, RealType m = 0)
+		    : beta(b), mu(m), density(0), energy(0)
+		{}
+
+		RealType beta;
+		RealType mu;
+		RealType density;
+		RealType energy;
+		MatrixType correlations;
+	};
+
+	typedef typename PsimagLite::Vector<ThermalPointType>::Type VectorThermalPointType;
+
+	// options is a comma-separated list, usually EngineOptions= of the
+	// input file, matched token by token, see EngineOptions.h; it selects the eigensolver with DivideAndConquer or
+	// Mrrr, while SolverBenchmark times every solver and keeps the fastest.
+	// EigenCache[=dir] reuses eigenpairs saved by an earlier run for the
+	// same matrix and dof, or saves them, see EigenCache.h.
+	// Blocks diagonalizes each connected component of the hopping graph
+	// on its own, in parallel, and keeps the eigenvectors block by block.
+	// Banded matrices (chains, ladders, periodic or not) go to the band
+	// solvers of EigenSolvers::banded() unless Dense is given.
+	// PlaneWaves builds the eigenbasis analytically if the matrix is
+	// translation invariant and the field complex, see PlaneWaves.h.
+	// Diagnostics=Summary|Text|Binary|Compressed sets how eigenvalues and
+	// eigenvectors are written if verbose, Summary by default, see
+	// DiagnosticsWriter.h.
+	// A complex field with a real hopping matrix is diagonalized by the
+	// real symmetric solvers and keeps real eigenvectors, unless Complex
+	// is given.
+	// Levels=a:b computes only the eigenpairs a,...,b-1, and Window=e1:e2
+	// only those with eigenvalue in [e1,e2), see EigenSolvers::partial();
+	// the other levels cannot be accessed, and neither transform(), the
+	// Green's functions nor HilbertState, which need them all, are available
 	Engine(const PsimagLite::Matrix<FieldType>& geometry,
 	       PsimagLite::String outputFile,
 	       SizeType dof,
-	       VerboseEnum verbose)
+	       VerboseEnum verbose,
+	       PsimagLite::String options = "")
 	    : dof_(dof),
 	      verbose_(verbose),
+	      solver_(EigenSolverEnum::DEFAULT),
 	      eigenvectors_(geometry),
-	      fout_(outputFile.c_str(), std::ios::app)
+	      realPath_(true),
+	      sites_(geometry.n_row()),
+	      partial_(false),
+	      firstLevel_(0),
+	      dense_(0),
+	      zero_(0.0),
+	      greensFunctionCache_(*this)
 	{
-		diagonalize();
+		EngineOptions engineOptions(options);
+		diagnostics_ = DiagnosticsWriter::open(outputFile,
+		                                       DiagnosticsWriter::fromOptions(engineOptions),
+		                                       true);
+		if (engineOptions.isSet("DivideAndConquer"))
+			solver_ = EigenSolverEnum::DIVIDE_AND_CONQUER;
+		if (engineOptions.isSet("Mrrr"))
+			solver_ = EigenSolverEnum::MRRR;
+		bool solverBenchmark = engineOptions.isSet("SolverBenchmark");
+		bool blocks = engineOptions.isSet("Blocks");
+		bool band = !engineOptions.isSet("Dense");
+		bool planeWaves = engineOptions.isSet("PlaneWaves");
+		realPath_ = !engineOptions.isSet("Complex");
+		typename EigenSolversType::RangeType range;
+		partial_ = EigenSolversType::rangeFromOptions(engineOptions,range);
+		PsimagLite::String cacheDir;
+		if (partial_) {
+			diagonalizePartial(range);
+		} else if (EigenCacheType::fromOptions(engineOptions,cacheDir)) {
+			EigenCacheType cache(eigenvectors_,dof_,cacheDir);
+			if (loadCache(cache)) {
+				std::cerr<<"Engine: eigenpairs read from "<<cache.filename()<<"\n";
+			} else {
+				diagonalize(solverBenchmark,blocks,band,planeWaves);
+				saveCache(cache);
+			}
+		} else {
+			diagonalize(solverBenchmark,blocks,band,planeWaves);
+		}
+
+		setDense();
+		energies_.resize(eigenvalues_.size() + 1);
+		energies_[0] = 0;
+		for (SizeType i=0;i<eigenvalues_.size();i++)
+			energies_[i + 1] = energies_[i] + eigenvalues_[i];
+
 		if (verbose_ == VerboseEnum::YES) {
-			fout_<<"Eigenvalues\n";
-			fout_<<eigenvalues_;
-			fout_<<"#Created core "<<eigenvectors_.n_row();
-			fout_<<"  times "<<eigenvectors_.n_col()<<"\n";
+			diagnostics_->write("Eigenvalues",eigenvalues_);
+			*diagnostics_<<"#Created core "<<size();
+			*diagnostics_<<"  times "<<levels()<<"\n";
 		}
 	}
 
+	// the eigenvectors are written without a copy, see writeNoCopy()
+	~Engine()
+	{
+		diagnostics_->flush();
+	}
+
+	// sum of the ne lowest eigenvalues, from prefix sums
 	RealType energy(SizeType ne) const
 	{
-		RealType sum = 0;
-		for (SizeType i=0;i<ne;i++) sum += eigenvalues_[i];
-		return sum;
+		if (ne > 0 && firstLevel_ > 0)
+			throw PsimagLite::RuntimeError("Engine::energy(): lowest levels not computed\n");
+		if (ne >= energies_.size())
+			throw PsimagLite::RuntimeError("Engine::energy(): more electrons than levels\n");
+		return energies_[ne];
 	}
 
-	const RealType& eigenvalue(SizeType i) const { return eigenvalues_[i]; }
+	const RealType& eigenvalue(SizeType i) const
+	{
+		if (!partial_) return eigenvalues_[i];
+		return eigenvalues_[level(i)];
+	}
 
+	// dense_ is chosen once in the constructor, see setDense()
 	const FieldType& eigenvector(SizeType i,SizeType j) const
 	{
-		return eigenvectors_(i,j);
+		if (partial_) j = level(j);
+
+		if (dense_) return dense_[i + j*sites_];
+
+		SizeType b = blockOfLevel_[j];
+		if (blockOfSite_[i] != b) return zero_;
+		return blocks_[b].vectors(localOfSite_[i],localOfLevel_[j]);
 	}
 
+	// m = U^dagger m U
 	void transform(MatrixType& m) const
 	{
-		MatrixType tmp = multiplyTransposeConjugate(eigenvectors_, m);
-		m = tmp * eigenvectors_;
+		checkFullSpectrum("transform");
+		TransformScratchType scratch;
+		transform(m,scratch);
+	}
+
+	// Same as transform() on each matrix, reusing one scratch space
+	void transform(typename PsimagLite::Vector<MatrixType>::Type& ms) const
+	{
+		checkFullSpectrum("transform");
+		TransformScratchType scratch;
+		for (SizeType i=0;i<ms.size();i++)
+			transform(ms[i],scratch);
+	}
+
+	// For each point, with f_k = 1/(1 + exp(beta(E_k - mu))) and one flavor,
+	// density sum_k f_k, energy sum_k E_k f_k and, if withCorrelations,
+	// <c^dagger_i c_j> = sum_k U(i,k) f_k U*(j,k), one GEMM per point
+	// on a single copy of the eigenvectors
+	void thermal(VectorThermalPointType& points,bool withCorrelations = true) const
+	{
+		checkFullSpectrum("thermal");
+		SizeType n = size();
+		MatrixType u;
+		MatrixType w;
+		if (withCorrelations && n > 0) {
+			u.resize(n,n);
+			w.resize(n,n);
+			for (SizeType k=0;k<n;k++)
+				for (SizeType i=0;i<n;i++)
+					u(i,k) = eigenvector(i,k);
+		}
+
+		VectorRealType f(n);
+		for (SizeType p=0;p<points.size();p++) {
+			ThermalPointType& point = points[p];
+			point.density = point.energy = 0;
+			for (SizeType k=0;k<n;k++) {
+				f[k] = 1.0/(1.0 + exp(point.beta*(eigenvalues_[k] - point.mu)));
+				point.density += f[k];
+				point.energy += eigenvalues_[k]*f[k];
+			}
+
+			if (!withCorrelations) continue;
+
+			point.correlations.resize(n,n);
+			if (n == 0) continue;
+			for (SizeType k=0;k<n;k++)
+				for (SizeType i=0;i<n;i++)
+					w(i,k) = u(i,k)*f[k];
+
+			FieldType one = 1.0;
+			psimag::BLAS::GEMM('N','C',n,n,n,one,&(w(0,0)),n,&(u(0,0)),n,
+			                   zero_,&(point.correlations(0,0)),n);
+		}
 	}
 
 	SizeType dof() const { return dof_; }
 
-	SizeType size() const { return eigenvalues_.size(); }
+	EigenSolverEnum solver() const { return solver_; }
+
+	// number of sites, which is also the number of levels
+	SizeType size() const { return sites_; }
+
+	// the levels computed are firstLevel(),...,firstLevel() + levels() - 1,
+	// all of them unless Levels= or Window= was given
+	SizeType firstLevel() const { return firstLevel_; }
+
+	SizeType levels() const { return eigenvalues_.size(); }
+
+	// true if the eigenvectors are stored as real numbers
+	bool realEigenvectors() const { return (realEigenvectors_.n_row() > 0); }
+
+	// 0 if the eigenvectors are dense, see Blocks in the constructor
+	SizeType blocks() const { return blocks_.size(); }
+
+	// the plane-wave basis, if the PlaneWaves option took effect
+	const PlaneWavesType* planeWaves() const { return planeWaves_.get(); }
+
+	// G(i,j;t) and G(i,j;z) computed on demand, see GreensFunctionCache.h;
+	// lookups are const and thread safe. For another memory budget, build
+	// a GreensFunctionCacheType on this Engine instead
+	const GreensFunctionCacheType& greensFunctionCache() const
+	{
+		checkFullSpectrum("greensFunctionCache");
+		return greensFunctionCache_;
+	}
 
 private:
 
-	void diagonalize()
+	typedef typename PsimagLite::Vector<SizeType>::Type VectorSizeType;
+	typedef typename PsimagLite::Vector<RealType>::Type VectorRealType;
+
+	// A connected component: its sites, its eigenpairs, and the
+	// global (sorted) index of each of its eigenvalues
+	struct BlockType {
+		VectorSizeType sites;
+		MatrixType vectors;
+		VectorRealType values;
+		VectorSizeType levels;
+	};
+
+	typedef PsimagLite::Matrix<RealType> MatrixRealType;
+	typedef EigenSolvers<RealType> EigenSolversRealType;
+
+	// Real eigenvectors are tried first if the real path is on; a file
+	// with the other kind is ignored, and overwritten by saveCache()
+	bool loadCache(const EigenCacheType& cache)
+	{
+		if (realPath_ && PsimagLite::IsComplexNumber<FieldType>::True &&
+		        cache.load(realEigenvectors_,eigenvalues_)) {
+			eigenvectors_.clear();
+			return true;
+		}
+
+		return cache.load(eigenvectors_,eigenvalues_);
+	}
+
+	// the cache only knows eigenvectors in one dense matrix, real or not
+	void saveCache(const EigenCacheType& cache) const
+	{
+		if (blocks_.size() > 0 || planeWaves_ || partial_) return;
+
+		if (realEigenvectors_.n_row() > 0)
+			cache.save(realEigenvectors_,eigenvalues_);
+		else
+			cache.save(eigenvectors_,eigenvalues_);
+	}
+
+	// index into eigenvalues_ and the eigenvector columns of level lambda
+	SizeType level(SizeType lambda) const
+	{
+		if (lambda < firstLevel_ || lambda >= firstLevel_ + eigenvalues_.size())
+			throw PsimagLite::RuntimeError("Engine: level " + ttos(lambda) +
+			                               " outside the computed window\n");
+		return lambda - firstLevel_;
+	}
+
+	// Points dense_ to the eigenvectors, column by column, unless they
+	// are kept in blocks. Real and plane-wave eigenvectors are copied
+	// once as FieldType, so that eigenvector() is a single load
+	void setDense()
+	{
+		dense_ = 0;
+		if (blocks_.size() > 0) return;
+
+		const MatrixType* m = &eigenvectors_;
+		if (planeWaves_ || realEigenvectors_.n_row() > 0) {
+			SizeType levels = eigenvalues_.size();
+			fieldEigenvectors_.resize(sites_,levels);
+			for (SizeType j=0;j<levels;j++)
+				for (SizeType i=0;i<sites_;i++)
+					fieldEigenvectors_(i,j) = (planeWaves_) ? planeWaves_->eigenvector(i,j)
+					                                        : realEigenvectors_(i,j);
+			m = &fieldEigenvectors_;
+		}
+
+		if (m->n_row() > 0 && m->n_col() > 0) dense_ = &((*m)(0,0));
+	}
+
+	void checkFullSpectrum(PsimagLite::String what) const
+	{
+		if (!partial_) return;
+		throw PsimagLite::RuntimeError("Engine::" + what + "() needs the full spectrum," +
+		                               " not given with Levels= or Window=\n");
+	}
+
+	// workspace of transform(), kept between the matrices of a batch
+	struct TransformScratchType {
+		MatrixType tmp;
+		MatrixType rows;
+		VectorSizeType rowOf;
+		MatrixRealType part;
+		MatrixRealType imagPart;
+		MatrixRealType realTmp;
+	};
+
+	void transform(MatrixType& m,TransformScratchType& scratch) const
+	{
+		if (planeWaves_) {
+			planeWaves_->transform(m);
+			return;
+		}
+
+		if (blocks_.size() > 0) {
+			transformBlocks(m);
+			return;
+		}
+
+		SizeType n = size();
+		if (n == 0) return;
+
+		// rows of m that have non-zeros, numbered in scratch.rowOf
+		SizeType nonZeros = 0;
+		SizeType rows = 0;
+		scratch.rowOf.assign(n,n);
+		for (SizeType j=0;j<n;j++) {
+			for (SizeType i=0;i<n;i++) {
+				if (m(i,j) == zero_) continue;
+				++nonZeros;
+				if (scratch.rowOf[i] == n) scratch.rowOf[i] = rows++;
+			}
+		}
+
+		bool sparse = (nonZeros*n + rows*n*n < 2*n*n*n);
+		if (realEigenvectors_.n_row() == 0) {
+			if (sparse)
+				transformSparse(m,scratch,rows,eigenvectors_);
+			else
+				transformDense(m,scratch);
+			return;
+		}
+
+		if (sparse)
+			transformSparse(m,scratch,rows,realEigenvectors_);
+		else
+			transformDenseReal(m,scratch);
+	}
+
+	// With U real, U^T m U is U^T Re(m) U + i U^T Im(m) U:
+	// four real GEMMs instead of two complex ones
+	void transformDenseReal(MatrixType& m,TransformScratchType& scratch) const
+	{
+		SizeType n = size();
+		RealType one = 1.0;
+		RealType zero = 0.0;
+		const MatrixRealType& u = realEigenvectors_;
+		scratch.part.resize(n,n);
+		scratch.imagPart.resize(n,n);
+		scratch.realTmp.resize(n,n);
+		for (SizeType j=0;j<n;j++) {
+			for (SizeType i=0;i<n;i++) {
+				scratch.part(i,j) = PsimagLite::real(m(i,j));
+				scratch.imagPart(i,j) = PsimagLite::imag(m(i,j));
+			}
+		}
+
+		for (SizeType k=0;k<2;k++) {
+			if (k == 1) scratch.part = scratch.imagPart;
+
+			psimag::BLAS::GEMM('T','N',n,n,n,one,&(u(0,0)),n,&(scratch.part(0,0)),n,
+			                   zero,&(scratch.realTmp(0,0)),n);
+			psimag::BLAS::GEMM('N','N',n,n,n,one,&(scratch.realTmp(0,0)),n,
+			                   &(u(0,0)),n,zero,&(scratch.part(0,0)),n);
+			for (SizeType j=0;j<n;j++)
+				for (SizeType i=0;i<n;i++)
+					setPart(m(i,j),scratch.part(i,j),k);
+		}
+	}
+
+	static void setPart(RealType& dest,RealType value,SizeType k)
+	{
+		if (k == 0) dest = value;
+	}
+
+	static void setPart(std::complex<RealType>& dest,RealType value,SizeType k)
+	{
+		dest = (k == 0) ? std::complex<RealType>(value,0.0)
+		                : std::complex<RealType>(dest.real(),value);
+	}
+
+	// two GEMMs, the second one writing into m
+	void transformDense(MatrixType& m,TransformScratchType& scratch) const
+	{
+		SizeType n = size();
+		FieldType one = 1.0;
+		scratch.tmp.resize(n,n);
+		psimag::BLAS::GEMM('C','N',n,n,n,one,&(eigenvectors_(0,0)),n,
+		                   &(m(0,0)),n,zero_,&(scratch.tmp(0,0)),n);
+		psimag::BLAS::GEMM('N','N',n,n,n,one,&(scratch.tmp(0,0)),n,
+		                   &(eigenvectors_(0,0)),n,zero_,&(m(0,0)),n);
+	}
+
+	// With R the rows of m that have non-zeros,
+	// U^dagger m U = U(R,:)^dagger (m(R,:) U), where m(R,:) U costs
+	// n per non-zero and the product one GEMM of inner size |R|;
+	// a site-diagonal or bond operator is then O(n^2)
+	template<typename SomeMatrixType>
+	void transformSparse(MatrixType& m,
+	                     TransformScratchType& scratch,
+	                     SizeType rows,
+	                     const SomeMatrixType& u) const
+	{
+		SizeType n = size();
+		if (rows == 0) return;
+
+		scratch.rows.resize(rows,n);
+		scratch.tmp.resize(rows,n);
+		for (SizeType b=0;b<n;b++)
+			for (SizeType r=0;r<rows;r++)
+				scratch.tmp(r,b) = zero_;
+
+		for (SizeType j=0;j<n;j++) {
+			for (SizeType i=0;i<n;i++) {
+				if (m(i,j) == zero_) continue;
+				SizeType r = scratch.rowOf[i];
+				FieldType value = m(i,j);
+				for (SizeType b=0;b<n;b++)
+					scratch.tmp(r,b) += value*u(j,b);
+			}
+		}
+
+		for (SizeType i=0;i<n;i++) {
+			SizeType r = scratch.rowOf[i];
+			if (r == n) continue;
+			for (SizeType b=0;b<n;b++)
+				scratch.rows(r,b) = u(i,b);
+		}
+
+		FieldType one = 1.0;
+		psimag::BLAS::GEMM('C','N',n,n,rows,one,&(scratch.rows(0,0)),rows,
+		                   &(scratch.tmp(0,0)),rows,zero_,&(m(0,0)),n);
+	}
+
+	// U^dagger m U, one pair of blocks at a time
+	void transformBlocks(MatrixType& m) const
+	{
+		MatrixType result(size(),size());
+		for (SizeType b1=0;b1<blocks_.size();b1++) {
+			const BlockType& x = blocks_[b1];
+			for (SizeType b2=0;b2<blocks_.size();b2++) {
+				const BlockType& y = blocks_[b2];
+				MatrixType sub(x.sites.size(),y.sites.size());
+				bool isZero = true;
+				for (SizeType a=0;a<x.sites.size();a++) {
+					for (SizeType c=0;c<y.sites.size();c++) {
+						sub(a,c) = m(x.sites[a],y.sites[c]);
+						if (sub(a,c) != zero_) isZero = false;
+					}
+				}
+
+				if (isZero) continue;
+				MatrixType tmp = multiplyTransposeConjugate(x.vectors,sub);
+				MatrixType tmp2 = tmp*y.vectors;
+				for (SizeType a=0;a<x.levels.size();a++)
+					for (SizeType c=0;c<y.levels.size();c++)
+						result(x.levels[a],y.levels[c]) = tmp2(a,c);
+			}
+		}
+
+		m = result;
+	}
+
+	void diagonalize(bool solverBenchmark,bool blocks,bool band,bool planeWaves)
 	{
 		if (!isHermitian(eigenvectors_,true)) throw std::runtime_error("Matrix not hermitian\n");
 
-		diag(eigenvectors_,eigenvalues_,'V');
+		if (planeWaves && diagonalizePlaneWaves()) return;
+
+		if (blocks && findBlocks() > 1) {
+			diagonalizeBlocks(band);
+			return;
+		}
+
+		if (!solverBenchmark && realPath_ && diagonalizeReal(band)) return;
+
+		if (solverBenchmark)
+			benchmark();
+		else if (!band || !EigenSolversType::banded(eigenvectors_,eigenvalues_))
+			EigenSolversType::diagonalize(eigenvectors_,eigenvalues_,solver_);
+
+		if (verbose_ == VerboseEnum::YES) {
+			diagnostics_->writeNoCopy("Eigenvectors",eigenvectors_);
+		}
+	}
+
+	// Only the eigenpairs in range, with the real solvers if the hopping
+	// matrix is real; blocks, bands and plane waves are not tried
+	void diagonalizePartial(const typename EigenSolversType::RangeType& range)
+	{
+		if (!isHermitian(eigenvectors_,true)) throw std::runtime_error("Matrix not hermitian\n");
+
+		if (realPath_ && toReal()) {
+			typename EigenSolversRealType::RangeType realRange;
+			realRange.byEnergy = range.byEnergy;
+			realRange.first = range.first;
+			realRange.last = range.last;
+			realRange.low = range.low;
+			realRange.high = range.high;
+			firstLevel_ = EigenSolversRealType::partial(realEigenvectors_,
+			                                            eigenvalues_,
+			                                            realRange);
+		} else {
+			firstLevel_ = EigenSolversType::partial(eigenvectors_,eigenvalues_,range);
+		}
+
+		if (verbose_ == VerboseEnum::YES) {
+			*diagnostics_<<"#Levels "<<firstLevel_<<" "<<eigenvalues_.size()<<"\n";
+		}
+	}
+
+	// Moves a real hopping matrix of a complex field to realEigenvectors_;
+	// false, doing nothing, otherwise
+	bool toReal()
+	{
+		if (!PsimagLite::IsComplexNumber<FieldType>::True) return false;
+
+		SizeType n = eigenvectors_.n_row();
+		for (SizeType j=0;j<n;j++)
+			for (SizeType i=0;i<n;i++)
+				if (PsimagLite::imag(eigenvectors_(i,j)) != 0) return false;
+
+		realEigenvectors_.resize(n,n);
+		for (SizeType j=0;j<n;j++)
+			for (SizeType i=0;i<n;i++)
+				realEigenvectors_(i,j) = PsimagLite::real(eigenvectors_(i,j));
+		eigenvectors_.clear();
+		return true;
+	}
+
+	// Real symmetric solvers for a complex field whose hopping matrix
+	// is real; false, doing nothing, otherwise
+	bool diagonalizeReal(bool band)
+	{
+		if (!toReal()) return false;
+
+		if (!band || !EigenSolversRealType::banded(realEigenvectors_,eigenvalues_))
+			EigenSolversRealType::diagonalize(realEigenvectors_,eigenvalues_,solver_);
+
+		if (verbose_ == VerboseEnum::YES) {
+			diagnostics_->writeNoCopy("Eigenvectors",realEigenvectors_);
+		}
+
+		return true;
+	}
+
+	// Diagonalizes a copy of the hopping matrix with each solver,
+	// reports the times, and keeps the result of the fastest
+	void benchmark()
+	{
+		EigenSolverEnum solvers[] = {EigenSolverEnum::DEFAULT,
+		                             EigenSolverEnum::DIVIDE_AND_CONQUER,
+		                             EigenSolverEnum::MRRR};
+		MatrixType bestVectors;
+		double best = 0;
+		for (SizeType i=0;i<3;i++) {
+			MatrixType m = eigenvectors_;
+			typename PsimagLite::Vector<RealType>::Type eigs;
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			EigenSolversType::diagonalize(m,eigs,solvers[i]);
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			PsimagLite::String name = EigenSolversType::name(solvers[i]);
+			std::cerr<<"Engine: solver "<<name<<" took "<<elapsed.count()<<" s\n";
+			*diagnostics_<<"#EngineSolver "<<name<<" "<<elapsed.count()<<"\n";
+			if (i>0 && elapsed.count()>=best) continue;
+			best = elapsed.count();
+			solver_ = solvers[i];
+			bestVectors = m;
+			eigenvalues_ = eigs;
+		}
+
+		eigenvectors_ = bestVectors;
+		std::cerr<<"Engine: using solver "<<EigenSolversType::name(solver_)<<"\n";
+	}
+
+	bool diagonalizePlaneWaves()
+	{
+		SizeType cell = PlaneWavesType::findCell(eigenvectors_);
+		if (cell == 0) {
+			std::cerr<<"Engine: PlaneWaves ignored, no translation symmetry";
+			std::cerr<<" or real field\n";
+			return false;
+		}
+
+		planeWaves_.reset(new PlaneWavesType(eigenvectors_,cell));
+		eigenvalues_ = planeWaves_->eigenvalues();
+		eigenvectors_.clear();
+		if (verbose_ == VerboseEnum::YES) {
+			*diagnostics_<<"#PlaneWaves cell "<<cell<<" cells "<<planeWaves_->cells()<<"\n";
+		}
+
+		return true;
+	}
+
+	// Connected components of the graph whose edges are the non-zero
+	// hoppings, found breadth first; returns how many there are
+	SizeType findBlocks()
+	{
+		SizeType n = eigenvectors_.n_row();
+		blockOfSite_.assign(n,n);
+		localOfSite_.resize(n);
+		blocks_.clear();
+		for (SizeType start=0;start<n;start++) {
+			if (blockOfSite_[start] != n) continue;
+			SizeType b = blocks_.size();
+			blocks_.push_back(BlockType());
+			VectorSizeType& sites = blocks_[b].sites;
+			blockOfSite_[start] = b;
+			sites.push_back(start);
+			for (SizeType k=0;k<sites.size();k++) {
+				SizeType i = sites[k];
+				for (SizeType j=0;j<n;j++) {
+					if (blockOfSite_[j] != n || eigenvectors_(i,j) == zero_) continue;
+					blockOfSite_[j] = b;
+					sites.push_back(j);
+				}
+			}
+
+			std::sort(sites.begin(),sites.end());
+			for (SizeType k=0;k<sites.size();k++)
+				localOfSite_[sites[k]] = k;
+		}
+
+		if (blocks_.size() < 2) blocks_.clear();
+		return (blocks_.size() < 2) ? 1 : blocks_.size();
+	}
+
+	void diagonalizeBlocks(bool band)
+	{
+		typedef PsimagLite::Parallelizer2<> ParallelizerType;
+		ParallelizerType parallelizer(PsimagLite::Concurrency::codeSectionParams);
+		EigenSolverEnum solver = solver_;
+		const MatrixType& m = eigenvectors_;
+		typename PsimagLite::Vector<BlockType>::Type& blocks = blocks_;
+		parallelizer.parallelFor(0,blocks_.size(),[&blocks,&m,solver,band](SizeType b,SizeType)
+		{
+			BlockType& block = blocks[b];
+			SizeType nb = block.sites.size();
+			block.vectors.resize(nb,nb);
+			for (SizeType a=0;a<nb;a++)
+				for (SizeType c=0;c<nb;c++)
+					block.vectors(a,c) = m(block.sites[a],block.sites[c]);
+			if (!band || !EigenSolversType::banded(block.vectors,block.values))
+				EigenSolversType::diagonalize(block.vectors,block.values,solver);
+		});
+
+		// merge the spectra, ties going to the lower block
+		SizeType n = eigenvectors_.n_row();
+		VectorSizeType next(blocks_.size(),0);
+		eigenvalues_.resize(n);
+		blockOfLevel_.resize(n);
+		localOfLevel_.resize(n);
+		for (SizeType b=0;b<blocks_.size();b++)
+			blocks_[b].levels.resize(blocks_[b].values.size());
+		for (SizeType lambda=0;lambda<n;lambda++) {
+			SizeType best = blocks_.size();
+			for (SizeType b=0;b<blocks_.size();b++) {
+				if (next[b] == blocks_[b].values.size()) continue;
+				if (best < blocks_.size() &&
+				        blocks_[b].values[next[b]] >= blocks_[best].values[next[best]])
+					continue;
+				best = b;
+			}
+
+			SizeType k = next[best]++;
+			eigenvalues_[lambda] = blocks_[best].values[k];
+			blockOfLevel_[lambda] = best;
+			localOfLevel_[lambda] = k;
+			blocks_[best].levels[k] = lambda;
+		}
 
+		eigenvectors_.clear();
 		if (verbose_ == VerboseEnum::YES) {
-			fout_<<"eigenvalues\n";
-			fout_<<eigenvalues_;
-			fout_<<"*************\n";
-			fout_<<"Eigenvectors:\n";
-			fout_<<eigenvectors_;
+			*diagnostics_<<"#Blocks "<<blocks_.size()<<"\n";
+			for (SizeType b=0;b<blocks_.size();b++)
+				*diagnostics_<<"#Block "<<b<<" sites "<<blocks_[b].sites.size()<<"\n";
 		}
 	}
 
 	// degrees of freedom that are simply repetition (hoppings are diagonal in these)
 	SizeType dof_;
 	VerboseEnum verbose_;
+	EigenSolverEnum solver_;
 	MatrixType eigenvectors_;
+	bool realPath_;
+	SizeType sites_;
+	bool partial_;
+	SizeType firstLevel_;
+	MatrixRealType realEigenvectors_;
+	MatrixType fieldEigenvectors_;
+	const FieldType* dense_;
 	typename PsimagLite::Vector<RealType>::Type eigenvalues_;
-	std::ofstream fout_;
+	typename PsimagLite::Vector<RealType>::Type energies_;
+	DiagnosticsWriter::PointerType diagnostics_;
+	FieldType zero_;
+	typename PsimagLite::Vector<BlockType>::Type blocks_;
+	VectorSizeType blockOfSite_;
+	VectorSizeType localOfSite_;
+	VectorSizeType blockOfLevel_;
+	VectorSizeType localOfLevel_;
+	std::unique_ptr<PlaneWavesType> planeWaves_;
+	GreensFunctionCacheType greensFunctionCache_;
 }; // Engine
 } // namespace FreeFermions
 
@@ -0,0 +1,155 @@
+// BEGIN LICENSE BLOCK
+/*
+Copyright (c) 2009-2021, UT-Battelle, LLC
+All rights reserved
+
+[FreeFermions, Version 1.0.0]
+[by G.A., Oak Ridge National Laboratory]
+
+UT Battelle Open Source Software License 11242008
+
+OPEN SOURCE LICENSE
+
+Subject to the conditions of this License, each
+contributor to this software hereby grants, free of
+charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), a
+perpetual, worldwide, non-exclusive, no-charge,
+royalty-free, irrevocable copyright license to use, copy,
+modify, merge, publish, distribute, and/or sublicense
+copies of the Software.
+
+1. Redistributions of Software must retain the above
+copyright and license notices, this list of conditions,
+and the following disclaimer.  Changes or modifications
+to, or derivative works of, the Software should be noted
+with comments and the contributor and organization's
+name.
+
+2. Neither the names of UT-Battelle, LLC or the
+Department of Energy nor the names of the Software
+contributors may be used to endorse or promote products
+derived from this software without specific prior written
+permission of UT-Battelle.
+
+3. The software and the end-user documentation included
+with the redistribution, with or without modification,
+must include the following acknowledgment:
+
+"This product includes software produced by UT-Battelle,
+LLC under Contract No. DE-AC05-00OR22725  with the
+Department of Energy."
+
+*********************************************************
+DISCLAIMER
+
+THE SOFTWARE IS SUPPLIED BY THE COPYRIGHT HOLDERS AND
+CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER, CONTRIBUTORS, UNITED STATES GOVERNMENT,
+OR THE UNITED STATES DEPARTMENT OF ENERGY BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+
+NEITHER THE UNITED STATES GOVERNMENT, NOR THE UNITED
+STATES DEPARTMENT OF ENERGY, NOR THE COPYRIGHT OWNER, NOR
+ANY OF THEIR EMPLOYEES, REPRESENTS THAT THE USE OF ANY
+INFORMATION, DATA, APPARATUS, PRODUCT, OR PROCESS
+DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+
+*********************************************************
+
+
+*/
+// END LICENSE BLOCK
+/** \ingroup DMRG */
+/*@{*/
+
+/*! \file EngineOptions.h
+ *
+ * The comma-separated options of Engine, usually EngineOptions= of
+ * the input file, split once into tokens
+ *
+ * A flag such as Dense is matched by a whole token, and an option such
+ * as EigenCache=dir by the key before its '='. So a value, for example
+ * a path containing Dense, never switches a mode on.
+ *
+ */
+#ifndef ENGINE_OPTIONS_H
+#define ENGINE_OPTIONS_H
+
+#include "Vector.h" // in PsimagLite
+
+namespace FreeFermions {
+
+class EngineOptions {
+
+	typedef PsimagLite::Vector<PsimagLite::String>::Type VectorStringType;
+
+public:
+
+	EngineOptions(PsimagLite::String options)
+	{
+		size_t start = 0;
+		while (start <= options.length()) {
+			size_t end = options.find(',',start);
+			if (end == PsimagLite::String::npos) end = options.length();
+			PsimagLite::String token = trim(options.substr(start,end - start));
+			if (token != "") tokens_.push_back(token);
+			start = end + 1;
+		}
+	}
+
+	// true if label is a token, or the key of a label=value token
+	bool isSet(PsimagLite::String label) const
+	{
+		for (SizeType i=0;i<tokens_.size();i++)
+			if (key(tokens_[i]) == label) return true;
+		return false;
+	}
+
+	// value of the first label=value token; false if there is none
+	bool value(PsimagLite::String& value,PsimagLite::String label) const
+	{
+		for (SizeType i=0;i<tokens_.size();i++) {
+			size_t equal = tokens_[i].find('=');
+			if (equal == PsimagLite::String::npos) continue;
+			if (tokens_[i].substr(0,equal) != label) continue;
+			value = tokens_[i].substr(equal + 1);
+			return true;
+		}
+
+		return false;
+	}
+
+private:
+
+	static PsimagLite::String key(const PsimagLite::String& token)
+	{
+		return token.substr(0,token.find('='));
+	}
+
+	static PsimagLite::String trim(const PsimagLite::String& str)
+	{
+		const char* blanks = " \t";
+		size_t first = str.find_first_not_of(blanks);
+		if (first == PsimagLite::String::npos) return "";
+		size_t last = str.find_last_not_of(blanks);
+		return str.substr(first,last - first + 1);
+	}
+
+	VectorStringType tokens_;
+}; // EngineOptions
+} // namespace FreeFermions
+
+/*@}*/
+#endif // ENGINE_OPTIONS_H
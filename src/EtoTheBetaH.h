@@ -87,6 +87,7 @@ public:
 	typedef EngineType_ EngineType;
 	typedef typename EngineType::RealType RealType;
 	typedef typename EngineType::FieldType FieldType;
+	typedef typename PsimagLite::Vector<FieldType>::Type VectorFieldType;
 
 	EToTheBetaH(RealType beta,
 	            const EngineType& engine,
@@ -115,6 +116,26 @@ public:
 		return exp(exponent);
 	}
 
+	SizeType gridSize() const { return 1; }
+
+	template<typename FreeOperatorsType>
+	void operator()(VectorFieldType& values,
+	                const FreeOperatorsType& freeOps,
+	                SizeType loc) const
+	{
+		values.resize(1);
+		values[0] = operator()(freeOps,loc);
+	}
+
+	// factor contributed by one operator applied before this one,
+	// so that operator() is the product of weights to its left
+	template<typename FreeOperatorsType>
+	FieldType weight(SizeType type, SizeType lambda) const
+	{
+		if (type != FreeOperatorsType::CREATION) return 1.0;
+		return exp(-beta_*engine_.eigenvalue(lambda));
+	}
+
 
 	void transpose() { }
 
@@ -88,18 +88,126 @@ public:
 	typedef EngineType_ EngineType;
 	typedef typename EngineType::RealType RealType;
 	typedef typename EngineType::FieldType FieldType;
+	typedef typename PsimagLite::Vector<RealType>::Type VectorRealType;
+	typedef typename PsimagLite::Vector<FieldType>::Type VectorFieldType;
 
 	EToTheIhTime(RealType time,
 	             const EngineType& engine,
 	             RealType energyOffset) :
 	    time_(time),
-	    engine_(engine),energyOffset_(energyOffset)
+	    engine_(engine),energyOffset_(energyOffset),
+	    step_(0)
 	{
 	}
 
+	// A grid of times, see gridSize() and operator()(values,...)
+	EToTheIhTime(const VectorRealType& times,
+	             const EngineType& engine,
+	             RealType energyOffset) :
+	    time_(0),
+	    times_(times),
+	    engine_(engine),energyOffset_(energyOffset),
+	    step_(0)
+	{
+		if (times_.size()==0)
+			throw PsimagLite::RuntimeError("EToTheIhTime: empty grid of times\n");
+
+		time_ = times_[0];
+		bool uniform = (times_.size()>1);
+		RealType step = (uniform) ? times_[1] - times_[0] : 0;
+		for (SizeType k=0;k<times_.size();k++) {
+			if (fabs(times_[k])>1000.0) uniform = false;
+			if (k>0 && fabs(times_[k] - times_[k-1] - step)>1e-12*(1+fabs(step)))
+				uniform = false;
+		}
+
+		if (uniform) step_ = step;
+	}
+
 	template<typename FreeOperatorsType>
 	FieldType operator()(const FreeOperatorsType& freeOps,
 	                     SizeType loc) const
+	{
+		if (times_.size()>1)
+			throw PsimagLite::RuntimeError("EToTheIhTime: grid needs values\n");
+
+		RealType sum = energy(freeOps,loc);
+		if (fabs(time_)>1000.0) return sum;
+		RealType exponent = -time_*sum;
+		return FieldType(cos(exponent),sin(exponent));
+	}
+
+	SizeType gridSize() const { return (times_.size()>1) ? times_.size() : 1; }
+
+	// values[k] is operator() at time k of the grid.
+	// On a uniform grid the phases follow by rotation, restarting
+	// from sin and cos every RESEED points to bound roundoff
+	template<typename FreeOperatorsType>
+	void operator()(VectorFieldType& values,
+	                const FreeOperatorsType& freeOps,
+	                SizeType loc) const
+	{
+		SizeType n = gridSize();
+		values.resize(n);
+		if (n==1) {
+			values[0] = operator()(freeOps,loc);
+			return;
+		}
+
+		RealType sum = energy(freeOps,loc);
+		if (step_==0) {
+			for (SizeType k=0;k<n;k++) {
+				RealType exponent = -times_[k]*sum;
+				values[k] = (fabs(times_[k])>1000.0) ?
+				            FieldType(sum) :
+				            FieldType(cos(exponent),sin(exponent));
+			}
+
+			return;
+		}
+
+		RealType exponent = -step_*sum;
+		FieldType rotation(cos(exponent),sin(exponent));
+		for (SizeType k=0;k<n;k++) {
+			if (k%RESEED==0) {
+				exponent = -times_[k]*sum;
+				values[k] = FieldType(cos(exponent),sin(exponent));
+				continue;
+			}
+
+			values[k] = values[k-1]*rotation;
+		}
+	}
+
+	// factor contributed by one operator applied before this one,
+	// so that operator() is the product of weights to its left
+	template<typename FreeOperatorsType>
+	FieldType weight(SizeType type, SizeType lambda) const
+	{
+		if (type != FreeOperatorsType::CREATION &&
+		        type != FreeOperatorsType::DESTRUCTION)
+			return 1.0;
+		if (fabs(time_)>1000.0 || times_.size()>1)
+			throw PsimagLite::RuntimeError("EToTheIhTime::weight(): |time|>1000 or grid\n");
+		int sign =  (type == FreeOperatorsType::CREATION) ? -1 : 1;
+		RealType exponent = -time_*engine_.eigenvalue(lambda)*sign;
+		return FieldType(cos(exponent),sin(exponent));
+	}
+
+	void transpose()
+	{
+		time_ = -time_;
+		step_ = -step_;
+		for (SizeType k=0;k<times_.size();k++)
+			times_[k] = -times_[k];
+	}
+
+private:
+
+	enum {RESEED = 64};
+
+	template<typename FreeOperatorsType>
+	RealType energy(const FreeOperatorsType& freeOps,SizeType loc) const
 	{
 		RealType sum = 0;
 		for (SizeType i=0;i<loc;i++) {
@@ -110,18 +218,15 @@ public:
 			             FreeOperatorsType::CREATION) ? -1 : 1;
 			sum += engine_.eigenvalue(freeOps[i].lambda)*sign;
 		}
-		if (fabs(time_)>1000.0) return sum;
-		RealType exponent = -time_*sum;
-		return FieldType(cos(exponent),sin(exponent));
-	}
-
-	void transpose() { time_ = -time_; }
 
-private:
+		return sum;
+	}
 
 	RealType time_;
+	VectorRealType times_;
 	const EngineType& engine_;
 	RealType energyOffset_;
+	RealType step_;
 }; // EToTheIhTime
 } // namespace Dmrg 
 
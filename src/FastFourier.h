@@ -0,0 +1,211 @@
+// BEGIN LICENSE BLOCK
+/*
+Copyright (c) 2009-2021, UT-Battelle, LLC
+All rights reserved
+
+[FreeFermions, Version 1.0.0]
+[by G.A., Oak Ridge National Laboratory]
+
+UT Battelle Open Source Software License 11242008
+
+OPEN SOURCE LICENSE
+
+Subject to the conditions of this License, each
+contributor to this software hereby grants, free of
+charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), a
+perpetual, worldwide, non-exclusive, no-charge,
+royalty-free, irrevocable copyright license to use, copy,
+modify, merge, publish, distribute, and/or sublicense
+copies of the Software.
+
+1. Redistributions of Software must retain the above
+copyright and license notices, this list of conditions,
+and the following disclaimer.  Changes or modifications
+to, or derivative works of, the Software should be noted
+with comments and the contributor and organization's
+name.
+
+2. Neither the names of UT-Battelle, LLC or the
+Department of Energy nor the names of the Software
+contributors may be used to endorse or promote products
+derived from this software without specific prior written
+permission of UT-Battelle.
+
+3. The software and the end-user documentation included
+with the redistribution, with or without modification,
+must include the following acknowledgment:
+
+"This product includes software produced by UT-Battelle,
+LLC under Contract No. DE-AC05-00OR22725  with the
+Department of Energy."
+
+*********************************************************
+DISCLAIMER
+
+THE SOFTWARE IS SUPPLIED BY THE COPYRIGHT HOLDERS AND
+CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER, CONTRIBUTORS, UNITED STATES GOVERNMENT,
+OR THE UNITED STATES DEPARTMENT OF ENERGY BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+
+NEITHER THE UNITED STATES GOVERNMENT, NOR THE UNITED
+STATES DEPARTMENT OF ENERGY, NOR THE COPYRIGHT OWNER, NOR
+ANY OF THEIR EMPLOYEES, REPRESENTS THAT THE USE OF ANY
+INFORMATION, DATA, APPARATUS, PRODUCT, OR PROCESS
+DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+
+*********************************************************
+
+
+*/
+// END LICENSE BLOCK
+/** \ingroup DMRG */
+/*@{*/
+
+/*! \file FastFourier.h
+ *
+ * Discrete Fourier transform of any length
+ *
+ * X_m = sum_x f_x exp(sign 2 pi i m x/L), unnormalized; lengths that
+ * are powers of two use radix-2, other lengths Bluestein's chirp
+ * convolution on a power of two, so every length is O(L log L)
+ *
+ */
+#ifndef FAST_FOURIER_H
+#define FAST_FOURIER_H
+
+#include "Vector.h" // in PsimagLite
+#include <cmath>
+#include <complex>
+
+namespace FreeFermions {
+
+template<typename RealType>
+class FastFourier {
+
+public:
+
+	typedef std::complex<RealType> ComplexType;
+	typedef typename PsimagLite::Vector<ComplexType>::Type VectorComplexType;
+
+	explicit FastFourier(SizeType length)
+	    : length_(length),
+	      size_(1)
+	{
+		if (length_ < 2) return;
+		while (size_ < length_) size_ <<= 1;
+		if (size_ != length_) {
+			size_ = 1;
+			while (size_ < 2*length_ - 1) size_ <<= 1;
+		}
+
+		roots_.resize(size_/2);
+		for (SizeType j=0;j<roots_.size();j++)
+			roots_[j] = std::polar<RealType>(1.0,-2.0*M_PI*j/size_);
+
+		if (size_ == length_) return;
+
+		// chirp_[j] = exp(-i pi j^2/L), with j^2 reduced mod 2L
+		chirp_.resize(length_);
+		for (SizeType j=0;j<length_;j++) {
+			SizeType j2 = (j*j) % (2*length_);
+			chirp_[j] = std::polar<RealType>(1.0,-M_PI*j2/length_);
+		}
+
+		kernel(kernelMinus_,-1);
+		kernel(kernelPlus_,1);
+	}
+
+	SizeType length() const { return length_; }
+
+	// v.size() must be length(); v is overwritten with its transform
+	void operator()(VectorComplexType& v,int sign) const
+	{
+		if (length_ < 2) return;
+		if (size_ == length_) {
+			radix2(v,sign);
+			return;
+		}
+
+		// X_m = c_m sum_x (f_x c_x) conj(c_{m-x}), c_j = exp(sign i pi j^2/L)
+		VectorComplexType a(size_,0.0);
+		for (SizeType x=0;x<length_;x++)
+			a[x] = v[x]*chirp(x,sign);
+		radix2(a,-1);
+		const VectorComplexType& b = (sign < 0) ? kernelMinus_ : kernelPlus_;
+		for (SizeType j=0;j<size_;j++) a[j] *= b[j];
+		radix2(a,1);
+		RealType factor = 1.0/size_;
+		for (SizeType m=0;m<length_;m++)
+			v[m] = a[m]*chirp(m,sign)*factor;
+	}
+
+private:
+
+	ComplexType chirp(SizeType j,int sign) const
+	{
+		return (sign < 0) ? chirp_[j] : std::conj(chirp_[j]);
+	}
+
+	// radix-2 transform of conj(c_j), j = -(L-1), ..., L-1, wrapped around
+	void kernel(VectorComplexType& b,int sign) const
+	{
+		b.assign(size_,0.0);
+		for (SizeType j=0;j<length_;j++) {
+			ComplexType value = std::conj(chirp(j,sign));
+			b[j] = value;
+			if (j > 0) b[size_ - j] = value;
+		}
+
+		radix2(b,-1);
+	}
+
+	// in place, v.size() == size_
+	void radix2(VectorComplexType& v,int sign) const
+	{
+		SizeType n = v.size();
+		for (SizeType i=1,j=0;i<n;i++) {
+			SizeType bit = n >> 1;
+			for (;j & bit;bit >>= 1) j ^= bit;
+			j ^= bit;
+			if (i < j) std::swap(v[i],v[j]);
+		}
+
+		for (SizeType len=2;len<=n;len <<= 1) {
+			SizeType stride = size_/len;
+			for (SizeType start=0;start<n;start+=len) {
+				for (SizeType k=0;k<len/2;k++) {
+					ComplexType w = roots_[k*stride];
+					if (sign > 0) w = std::conj(w);
+					ComplexType u = v[start+k];
+					ComplexType t = v[start+k+len/2]*w;
+					v[start+k] = u + t;
+					v[start+k+len/2] = u - t;
+				}
+			}
+		}
+	}
+
+	SizeType length_;
+	SizeType size_;
+	VectorComplexType roots_;
+	VectorComplexType chirp_;
+	VectorComplexType kernelMinus_;
+	VectorComplexType kernelPlus_;
+}; // FastFourier
+} // namespace FreeFermions
+
+/*@}*/
+#endif // FAST_FOURIER_H
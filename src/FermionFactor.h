@@ -88,13 +88,13 @@ DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
 namespace FreeFermions {
 
 
-template<typename OperatorType,typename OpPointerType>
+template<typename OperatorType,typename OpPointerType,SizeType CAPACITY = 256>
 class FermionFactor {
 
 public:
 
 	typedef typename OperatorType::RealType RealType;
-	typedef FreeOperators<OperatorType,OpPointerType> FreeOperatorsType;
+	typedef FreeOperators<OperatorType,OpPointerType,CAPACITY> FreeOperatorsType;
 	typedef PsimagLite::Vector<bool>::Type VectorBoolType;
 	typedef std::pair<SizeType, SizeType> PairSizeType;
 
@@ -126,26 +126,38 @@ public:
 
 private:
 
+	// One bit per operator, in as many 64-bit words as needed;
+	// scans use hardware bit-scan and popcount where available
 	class WhoIsOn {
 
-		static const SizeType MAX_BITS = 64;
+		typedef unsigned long long int WordType;
+
+		static const SizeType BITS = 64;
+		static const SizeType INLINE_WORDS = (CAPACITY + BITS - 1)/BITS;
 
 	public:
 
-		WhoIsOn(SizeType n) : word_(~0), n_(n), beginEnd_(0, n)
+		WhoIsOn(SizeType n)
+		    : n_(n),
+		      words_((n + BITS - 1)/BITS),
+		      beginEnd_(0, n),
+		      data_(inline_)
 		{
-			if (n >= MAX_BITS)
-				err("FermionFactor: hard limit of 64 bits exceeded\n");
+			if (words_ > INLINE_WORDS) {
+				overflow_.resize(words_);
+				data_ = &(overflow_[0]);
+			}
+
+			for (SizeType w = 0; w < words_; ++w) data_[w] = ~WordType(0);
+			SizeType rem = n_ % BITS;
+			if (rem > 0) data_[words_ - 1] = (WordType(1) << rem) - 1;
 		}
 
 		SizeType findActualIndex(SizeType ind) const
 		{
 			PairSizeType bE = fromPair(ind, n_);
-			long unsigned int mask = (1 << bE.first);
-			for (SizeType i = bE.first; i < bE.second; ++i) {
-				if (word_ & mask) return i;
-				mask <<= 1;
-			}
+			SizeType i = nextOn(bE.first);
+			if (i < bE.second) return i;
 
 			throw std::runtime_error("FreeOperators::findActualIndex()\n");
 		}
@@ -153,11 +165,17 @@ private:
 		SizeType count(SizeType from, SizeType to) const
 		{
 			PairSizeType bE = fromPair(from, to);
+			if (bE.first >= bE.second) return 0;
+
+			SizeType first = bE.first/BITS;
+			SizeType last = (bE.second - 1)/BITS;
 			SizeType counter = 0;
-			long unsigned int mask = (1 << bE.first);
-			for (SizeType i = bE.first; i < bE.second; ++i) {
-				if (word_ & mask) ++counter;
-				mask <<= 1;
+			for (SizeType w = first; w <= last; ++w) {
+				WordType word = data_[w];
+				if (w == first) word &= (~WordType(0) << (bE.first % BITS));
+				SizeType rem = bE.second % BITS;
+				if (w == last && rem > 0) word &= (WordType(1) << rem) - 1;
+				counter += popCount(word);
 			}
 
 			return counter;
@@ -174,47 +192,107 @@ private:
 		bool operator[](SizeType ind) const
 		{
 			assert(ind < n_);
-			const long unsigned int mask = (1 << ind);
-			return word_ & mask;
+			return (data_[ind/BITS] >> (ind % BITS)) & 1;
 		}
 
 		void set(SizeType ind, bool value)
 		{
 			assert(ind < n_);
-			const long unsigned int mask = (1 << ind);
-			const bool x = (word_ & mask);
-			if (value == x) return;
-			word_ ^= mask;
+			const WordType mask = (WordType(1) << (ind % BITS));
+			if (value)
+				data_[ind/BITS] |= mask;
+			else
+				data_[ind/BITS] &= ~mask;
 		}
 
 		void updateBounds()
 		{
-			long unsigned int mask = (1 << beginEnd_.first);
-			for (SizeType i = beginEnd_.first; i < beginEnd_.second; ++i) {
-				if (!(word_ & mask)) {
-					mask <<= 1;
-					continue;
-				}
-
-				if (i > beginEnd_.first) beginEnd_.first = i;
-				break;
-			}
+			SizeType i = nextOn(beginEnd_.first);
+			if (i >= beginEnd_.second) return;
+			beginEnd_.first = i;
+
+			SizeType j = previousOn(beginEnd_.second);
+			if (j + 1 < beginEnd_.second) beginEnd_.second = j + 1;
+		}
 
-			for (SizeType i = 0; i < beginEnd_.second; ++i) {
-				SizeType j = beginEnd_.second - i - 1;
-				long unsigned int mask = (1 << j);
-				if (!(word_ & mask)) continue;
-				if (j + 1 < beginEnd_.second)  beginEnd_.second = j + 1;
-				break;
+		// first bit on at or after ind, or n_ if none
+		SizeType nextOn(SizeType ind) const
+		{
+			if (ind >= n_) return n_;
+			SizeType w = ind/BITS;
+			WordType word = data_[w] & (~WordType(0) << (ind % BITS));
+			while (word == 0) {
+				if (++w == words_) return n_;
+				word = data_[w];
 			}
+
+			return w*BITS + trailingZeros(word);
 		}
 
 	private:
 
+		// last bit on before ind; there must be one
+		SizeType previousOn(SizeType ind) const
+		{
+			assert(ind > 0 && ind <= n_);
+			SizeType w = (ind - 1)/BITS;
+			SizeType rem = ind % BITS;
+			WordType word = data_[w];
+			if (rem > 0) word &= (WordType(1) << rem) - 1;
+			while (word == 0) {
+				assert(w > 0);
+				word = data_[--w];
+			}
+
+			return w*BITS + BITS - 1 - leadingZeros(word);
+		}
+
+		static SizeType popCount(WordType word)
+		{
+#ifdef __GNUC__
+			return __builtin_popcountll(word);
+#else
+			SizeType counter = 0;
+			for (; word; word &= word - 1) ++counter;
+			return counter;
+#endif
+		}
+
+		static SizeType trailingZeros(WordType word)
+		{
+			assert(word != 0);
+#ifdef __GNUC__
+			return __builtin_ctzll(word);
+#else
+			SizeType counter = 0;
+			for (; !(word & 1); word >>= 1) ++counter;
+			return counter;
+#endif
+		}
+
+		static SizeType leadingZeros(WordType word)
+		{
+			assert(word != 0);
+#ifdef __GNUC__
+			return __builtin_clzll(word);
+#else
+			SizeType counter = 0;
+			for (WordType mask = WordType(1) << (BITS - 1); !(word & mask); mask >>= 1)
+				++counter;
+			return counter;
+#endif
+		}
+
+		WhoIsOn(const WhoIsOn&);
+
+		WhoIsOn& operator=(const WhoIsOn&);
 
-		long unsigned int word_;
 		SizeType n_;
+		SizeType words_;
 		PairSizeType beginEnd_;
+		WordType inline_[INLINE_WORDS];
+		typename PsimagLite::Vector<WordType>::Type overflow_;
+		WordType* data_;
 	};
 
 	void pairUp(FreeOperatorsType& freeOps)
@@ -285,8 +363,8 @@ private:
 	{
 		const SizeType n = freeOps.size();
 		PairSizeType bE = bits.fromPair(start, n);
-		for (SizeType  i = bE.first; i < bE.second; ++i) {
-			if (!bits[i]) continue;
+		// visit only the bits that are on
+		for (SizeType i = bits.nextOn(bE.first); i < bE.second; i = bits.nextOn(i + 1)) {
 			if (FreeOperatorsType::notCreationOrDestruction(freeOps[i].type)) continue;
 			if (freeOps[i].lambda == thisLambda) return i;
 		}
@@ -0,0 +1,187 @@
+// BEGIN LICENSE BLOCK
+/*
+Copyright (c) 2009-2021, UT-Battelle, LLC
+All rights reserved
+
+[FreeFermions, Version 1.0.0]
+[by G.A., Oak Ridge National Laboratory]
+
+UT Battelle Open Source Software License 11242008
+
+OPEN SOURCE LICENSE
+
+Subject to the conditions of this License, each
+contributor to this software hereby grants, free of
+charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), a
+perpetual, worldwide, non-exclusive, no-charge,
+royalty-free, irrevocable copyright license to use, copy,
+modify, merge, publish, distribute, and/or sublicense
+copies of the Software.
+
+1. Redistributions of Software must retain the above
+copyright and license notices, this list of conditions,
+and the following disclaimer.  Changes or modifications
+to, or derivative works of, the Software should be noted
+with comments and the contributor and organization's
+name.
+
+2. Neither the names of UT-Battelle, LLC or the
+Department of Energy nor the names of the Software
+contributors may be used to endorse or promote products
+derived from this software without specific prior written
+permission of UT-Battelle.
+
+3. The software and the end-user documentation included
+with the redistribution, with or without modification,
+must include the following acknowledgment:
+
+"This product includes software produced by UT-Battelle,
+LLC under Contract No. DE-AC05-00OR22725  with the
+Department of Energy."
+
+*********************************************************
+DISCLAIMER
+
+THE SOFTWARE IS SUPPLIED BY THE COPYRIGHT HOLDERS AND
+CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER, CONTRIBUTORS, UNITED STATES GOVERNMENT,
+OR THE UNITED STATES DEPARTMENT OF ENERGY BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+
+NEITHER THE UNITED STATES GOVERNMENT, NOR THE UNITED
+STATES DEPARTMENT OF ENERGY, NOR THE COPYRIGHT OWNER, NOR
+ANY OF THEIR EMPLOYEES, REPRESENTS THAT THE USE OF ANY
+INFORMATION, DATA, APPARATUS, PRODUCT, OR PROCESS
+DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+
+*********************************************************
+
+
+*/
+// END LICENSE BLOCK
+/** \ingroup DMRG */
+/*@{*/
+
+/*! \file FillingScan.h
+ *
+ * Ground-state observables of one species for consecutive fillings
+ *
+ * At filling ne the ground state occupies the ne lowest levels, so
+ * C(i,j) = <c^dagger_i c_j> = sum_{lambda<ne} U(i,lambda) U*(j,lambda)
+ * and going to ne+1 is the rank-1 update C += u u^dagger with
+ * u = U(:,ne). Scanning every filling costs about as much as building
+ * C once at half filling.
+ *
+ */
+#ifndef FILLING_SCAN_H
+#define FILLING_SCAN_H
+
+#include "Complex.h" // in PsimagLite
+#include "Matrix.h" // in PsimagLite
+#include "Vector.h" // in PsimagLite
+
+namespace FreeFermions {
+
+template<typename EngineType>
+class FillingScan {
+
+public:
+
+	typedef typename EngineType::RealType RealType;
+	typedef typename EngineType::FieldType FieldType;
+	typedef typename PsimagLite::Vector<RealType>::Type VectorRealType;
+	typedef typename PsimagLite::Vector<FieldType>::Type VectorFieldType;
+	typedef PsimagLite::Matrix<FieldType> MatrixType;
+
+	// Starts at filling ne; without correlations only energy and
+	// density are kept, at O(n) per step
+	FillingScan(const EngineType& engine,
+	            SizeType ne,
+	            bool withCorrelations = true)
+	    : engine_(engine),
+	      filling_(0),
+	      withCorrelations_(withCorrelations),
+	      density_(engine.size(),0.0),
+	      u_(engine.size())
+	{
+		if (ne > engine_.size())
+			throw PsimagLite::RuntimeError("FillingScan: more electrons than levels\n");
+
+		if (withCorrelations_)
+			correlations_.resize(engine_.size(),engine_.size());
+
+		while (filling_ < ne) next();
+	}
+
+	SizeType filling() const { return filling_; }
+
+	bool full() const { return filling_ == engine_.size(); }
+
+	RealType energy() const { return engine_.energy(filling_); }
+
+	// <n_i>
+	const VectorRealType& density() const { return density_; }
+
+	// <c^dagger_i c_j>
+	const MatrixType& correlations() const
+	{
+		if (!withCorrelations_)
+			throw PsimagLite::RuntimeError("FillingScan: built without correlations\n");
+		return correlations_;
+	}
+
+	// adds one electron, in the lowest empty level
+	void next()
+	{
+		if (full())
+			throw PsimagLite::RuntimeError("FillingScan: no empty levels left\n");
+
+		SizeType n = engine_.size();
+		for (SizeType i=0;i<n;i++) {
+			u_[i] = engine_.eigenvector(i,filling_);
+			density_[i] += PsimagLite::real(u_[i]*PsimagLite::conj(u_[i]));
+		}
+
+		++filling_;
+		if (!withCorrelations_) return;
+
+		for (SizeType j=0;j<n;j++) {
+			FieldType uj = PsimagLite::conj(u_[j]);
+			if (uj == static_cast<RealType>(0)) continue;
+			for (SizeType i=0;i<n;i++)
+				correlations_(i,j) += u_[i]*uj;
+		}
+	}
+
+private:
+
+	FillingScan(const FillingScan&)
+	{
+		throw PsimagLite::RuntimeError("Don't even think of coming here\n");
+	}
+
+	FillingScan& operator=(const FillingScan&);
+
+	const EngineType& engine_;
+	SizeType filling_;
+	bool withCorrelations_;
+	VectorRealType density_;
+	VectorFieldType u_;
+	MatrixType correlations_;
+}; // FillingScan
+} // namespace FreeFermions
+
+/*@}*/
+#endif // FILLING_SCAN_H
@@ -86,20 +86,23 @@ DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
 #include "Sort.h" // in PsimagLite
 #include "Permutations.h"
 #include "IndexGenerator.h"
+#include <algorithm>
 #include <cassert>
 
 namespace FreeFermions {
 
+// trivial on purpose, so that FreeOperators' inline buffer is not zeroed
 struct FreeOperator {
-	FreeOperator() : lambda(0),type(0) {}
 	SizeType lambda;
 	SizeType type;
 };
 
-template<typename OperatorType,typename OpPointerType>
+// Operators are kept in an inline buffer of CAPACITY entries, so that
+// building one term does not allocate; longer strings spill to the heap
+template<typename OperatorType,typename OpPointerType,SizeType CAPACITY = 256>
 class FreeOperators {
 
-	enum {DRY_RUN,NORMAL_RUN};
+	typedef FreeOperators<OperatorType,OpPointerType,CAPACITY> ThisType;
 
 public:
 
@@ -114,49 +117,37 @@ public:
 		  DESTRUCTION = OperatorType::DESTRUCTION,
 		  DIAGONAL};
 
+	template<typename SomeLambdaType,typename SomeLambda2Type>
 	FreeOperators(const OpPointersType& opPointers,
-	              const IndexGeneratorType& lambda,
-	              const PermutationsType& lambda2,
+	              const SomeLambdaType& lambda,
+	              const SomeLambda2Type& lambda2,
 	              SizeType sigma,
 	              const typename PsimagLite::Vector<SizeType>::Type& occupations,
 	              const typename PsimagLite::Vector<SizeType>::Type& occupations2)
-	    : value_(1),loc_(0)
+	    : value_(1),data_(inline_),size_(0)
 	{
-		SizeType counter3 = addAtTheFront(occupations,DRY_RUN);
-		SizeType counter2=0;
+		SizeType counter3 = addAtTheFront(occupations);
 		SizeType counter = 0;
-		addAtTheMiddle(counter,counter2,opPointers,lambda,lambda2,sigma,DRY_RUN);
-		counter += counter3;
-
-		counter2 += addAtTheBack(occupations2,DRY_RUN);
-
-
-		data_.resize(loc_);
-		loc_=0;
-
-		addAtTheFront(occupations,NORMAL_RUN);
-		SizeType counter4=0;
-		SizeType counter5=0;
-		addAtTheMiddle(counter4,counter5,opPointers,lambda,lambda2,sigma,NORMAL_RUN);
-		addAtTheBack(occupations2,NORMAL_RUN);
+		SizeType counter2 = 0;
+		addAtTheMiddle(counter,counter2,opPointers,lambda,lambda2,sigma);
+		SizeType counter4 = addAtTheBack(occupations2);
 
 		// if daggers > non-daggers, result is zero
-		if (counter!=counter2) {
-			value_ = 0;
-			return;
-		}
+		if (counter3!=counter4 || counter!=counter2) value_ = 0;
 	}
 
 	void clear()
 	{
-		data_.clear();
+		size_ = 0;
+		data_ = inline_;
+		overflow_.clear();
 	}
 
 	SizeType findLocOfDiagOp(SizeType ind) const
 	{
 		SizeType counter = 0;
 		SizeType j = 0;
-		for (SizeType i = 0; i < data_.size(); i++) {
+		for (SizeType i = 0; i < size_; i++) {
 			if (data_[i].type == DIAGONAL) {
 				if (counter==ind) return j;
 				counter++;
@@ -172,43 +163,28 @@ public:
 
 	void removeNonCsOrDs()
 	{
-		const SizeType n = data_.size();
-		SizeType i = 0;
 		SizeType j = 0;
-		for (i = 0; i < n; ++i) {
-
-			SizeType offset = 0;
-			for (SizeType k = j; k  < n; ++k) {
-				SizeType type1 = data_[k].type;
-				if (type1 == CREATION || type1 == DESTRUCTION) break;
-				++offset;
-			}
-
-			j += offset;
-			if (j == n) break;
-			assert(j < data_.size());
-			if (i != j) data_[i] = data_[j];
+		for (SizeType i = 0; i < size_; ++i) {
+			if (notCreationOrDestruction(data_[i].type)) continue;
+			if (i != j) data_[j] = data_[i];
 			++j;
-			if (j == n) break;
 		}
 
-		data_.resize(i + 1);
+		size_ = j;
 	}
 
-	SizeType size() const { return data_.size(); }
+	SizeType size() const { return size_; }
 
-	const FreeOperator& operator[](SizeType i) const { return data_[i]; }
+	const FreeOperator& operator[](SizeType i) const
+	{
+		assert(i < size_);
+		return data_[i];
+	}
 
 	void reverse()
 	{
 		// flip'em
-		SizeType n = data_.size();
-		const SizeType nOver2 = (n & 1) ? (n - 1)/2 : n/2;
-		for (SizeType i = 0; i < nOver2; ++i) {
-			FreeOperator copy = data_[i];
-			data_[i] = data_[n - i - 1];
-			data_[n - i - 1] = copy;
-		}
+		std::reverse(data_, data_ + size_);
 	}
 
 	RealType operator()()
@@ -223,84 +199,92 @@ public:
 
 private:
 
-	SizeType addAtTheBack(const typename PsimagLite::Vector<SizeType>::Type& occupations2,
-	                      SizeType typeOfRun)
+	FreeOperators(const ThisType&)
+	{
+		throw std::runtime_error(
+		            "FreeOperators::copyCtor: Don't even think of coming here\n");
+	}
+
+	ThisType& operator=(const ThisType&)
+	{
+		throw std::runtime_error(
+		            "FreeOperators::assignmentOp: Don't even think of coming here\n");
+	}
+
+	void push(SizeType lambda, SizeType type)
+	{
+		FreeOperator fo;
+		fo.lambda = lambda;
+		fo.type = type;
+		if (size_ < CAPACITY) {
+			inline_[size_++] = fo;
+			return;
+		}
+
+		if (size_ == CAPACITY) overflow_.assign(inline_, inline_ + CAPACITY);
+		overflow_.push_back(fo);
+		data_ = &(overflow_[0]);
+		++size_;
+	}
+
+	SizeType addAtTheBack(const typename PsimagLite::Vector<SizeType>::Type& occupations2)
 	{
 		SizeType counter = 0;
 		for (int i=occupations2.size()-1;i>=0;i--) {
 			if (occupations2[i]==0) continue;
 			counter++;
-			if (typeOfRun==DRY_RUN) {
-				loc_++;
-				continue;
-			}
-			FreeOperator fo;
-			fo.lambda = i;
-			fo.type = DESTRUCTION;
-			data_[loc_++]=fo;
+			push(i,DESTRUCTION);
 		}
 
 		return counter;
 	}
 
-	SizeType addAtTheFront(const typename PsimagLite::Vector<SizeType>::Type& occupations,
-	                       SizeType typeOfRun)
+	SizeType addAtTheFront(const typename PsimagLite::Vector<SizeType>::Type& occupations)
 	{
 		SizeType counter = 0;
 		for (SizeType i=0;i<occupations.size();++i) {
 			if (occupations[i]==0) continue;
 			counter++;
-			if (typeOfRun==DRY_RUN) {
-				loc_++;
-				continue;
-			}
-			FreeOperator fo;
-			fo.lambda = i;
-			fo.type = CREATION;
-			data_[loc_++]=fo;
+			push(i,CREATION);
 		}
 		return counter;
 	}
 
+	template<typename SomeLambdaType,typename SomeLambda2Type>
 	void addAtTheMiddle(SizeType& counter,
 	                    SizeType& counter2,
 	                    const OpPointersType& opPointers,
-	                    const IndexGeneratorType& lambda,
-	                    const PermutationsType& lambda2,
-	                    SizeType sigma,
-	                    SizeType typeOfRun)
+	                    const SomeLambdaType& lambda,
+	                    const SomeLambda2Type& lambda2,
+	                    SizeType sigma)
 	{
 		for (SizeType i=0;i<opPointers.size();i++) {
-			FreeOperator fo;
-			fo.type = opPointers[i].type;
-			if (notCreationOrDestruction(fo.type)) {
-				fo.lambda = 0;
-				if (typeOfRun==NORMAL_RUN) data_[loc_++]=fo;
-				else loc_++;
+			SizeType type = opPointers[i].type;
+			if (notCreationOrDestruction(type)) {
+				push(0,type);
 				continue;
 			}
+
 			if (opPointers[i].sigma!=sigma) continue;
 
-			if (typeOfRun==DRY_RUN) {
-				loc_++;
-				continue;
-			}
-			if (fo.type==CREATION) {
-				if (counter<lambda.size()) fo.lambda = lambda[counter];
+			SizeType thisLambda = 0;
+			if (type==CREATION) {
+				if (counter<lambda.size()) thisLambda = lambda[counter];
 				counter++;
-			} else if (fo.type==DESTRUCTION) {
-				if (counter2<lambda2.size()) fo.lambda = lambda2[counter2];
-				counter2++;
 			} else {
-				fo.lambda = 0;
+				if (counter2<lambda2.size()) thisLambda = lambda2[counter2];
+				counter2++;
 			}
-			data_[loc_++]=fo;
+
+			push(thisLambda,type);
 		}
 	}
 
-	PsimagLite::Vector<FreeOperator>::Type data_;
 	RealType value_;
-	SizeType loc_;
+	FreeOperator inline_[CAPACITY];
+	PsimagLite::Vector<FreeOperator>::Type overflow_;
+	FreeOperator* data_;
+	SizeType size_;
 }; // FreeOperators
 } // namespace Dmrg 
 
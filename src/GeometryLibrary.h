@@ -83,6 +83,7 @@ DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
 #include "Matrix.h" // in psimaglite
 #include <cassert>
 #include "KTwoNiFFour.h"
+#include "DiagnosticsWriter.h"
 #include "PsimagLite.h"
 
 namespace FreeFermions {
@@ -121,7 +122,9 @@ public:
 	GeometryLibrary(GeometryParamsType& geometryParams,DecayEnum decay = DECAY_NONE)
 	    : geometryParams_(geometryParams),
 	      decay_(decay),
-	      fout_(geometryParams.outputFile.c_str())
+	      fout_(DiagnosticsWriter::open(geometryParams.outputFile,
+	                                    DiagnosticsWriter::fromOptions(EngineOptions(geometryParams.engineOptions)),
+	                                    false))
 	{
 		switch (geometryParams.type) {
 		case CHAIN:
@@ -163,9 +166,7 @@ public:
 		readPotential(v,potentialT_,geometryParams_.filename);
 		addPotential(v);
 
-		fout_<<"HoppingMatrix\n";
-		fout_<<t_;
-		fout_.flush();
+		fout_->write("HoppingMatrix",t_);
 	}
 
 	template<typename ComplexType>
@@ -415,14 +416,14 @@ private:
 			SizeType iyp1 = (iy + 1 < leg) ? iy + 1 : 0;
 			SizeType jp = (ix + 1)*leg + iyp1;
 			t_(i, jp) = geometryParams_.hopping[offsetp + i];
-			fout_<<"t("<<i<<","<<jp<<")="<<t_(i, jp)<<"\n";
+			*fout_<<"t("<<i<<","<<jp<<")="<<t_(i, jp)<<"\n";
 
 			t_(jp, i) = PsimagLite::conj(t_(i, jp));
 			SizeType iym1 = (iy == 0) ? leg - 1 : iy - 1;
 			SizeType jm = (ix + 1)*leg + iym1;
 			t_(i, jm) = geometryParams_.hopping[offsetm + i];
 			t_(jm, i) = PsimagLite::conj(t_(i, jm));
-			fout_<<"t("<<i<<","<<jm<<")="<<t_(i, jm)<<"\n";
+			*fout_<<"t("<<i<<","<<jm<<")="<<t_(i, jm)<<"\n";
 
 		}
 	}
@@ -825,7 +826,7 @@ private:
 	DecayEnum decay_;
 	VectorRealType potentialT_;
 	MatrixType t_;
-	std::ofstream fout_;
+	DiagnosticsWriter::PointerType fout_;
 }; // GeometryLibrary
 
 template<typename MatrixType,typename ParamsType>
@@ -136,6 +136,10 @@ struct GeometryParameters {
 			io.readline(phase,"phase=");
 		} catch (std::exception&) {}
 
+		try {
+			io.readline(engineOptions,"EngineOptions=");
+		} catch (std::exception&) {}
+
 		if (geometry == "LongRange" || geometry == "Raw") {
 			type = RAW;
 			return;
@@ -410,6 +414,7 @@ struct GeometryParameters {
 	SizeType bathSitesPerSite;
 	RealType omega;
 	RealType phase;
+	PsimagLite::String engineOptions;
 	typename PsimagLite::Vector<FieldType>::Type tb;
 }; // struct GeometryParameters
 } // namespace Dmrg
@@ -0,0 +1,332 @@
+// BEGIN LICENSE BLOCK
+/*
+Copyright (c) 2009-2021, UT-Battelle, LLC
+All rights reserved
+
+[FreeFermions, Version 1.0.0]
+[by G.A., Oak Ridge National Laboratory]
+
+UT Battelle Open Source Software License 11242008
+
+OPEN SOURCE LICENSE
+
+Subject to the conditions of this License, each
+contributor to this software hereby grants, free of
+charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), a
+perpetual, worldwide, non-exclusive, no-charge,
+royalty-free, irrevocable copyright license to use, copy,
+modify, merge, publish, distribute, and/or sublicense
+copies of the Software.
+
+1. Redistributions of Software must retain the above
+copyright and license notices, this list of conditions,
+and the following disclaimer.  Changes or modifications
+to, or derivative works of, the Software should be noted
+with comments and the contributor and organization's
+name.
+
+2. Neither the names of UT-Battelle, LLC or the
+Department of Energy nor the names of the Software
+contributors may be used to endorse or promote products
+derived from this software without specific prior written
+permission of UT-Battelle.
+
+3. The software and the end-user documentation included
+with the redistribution, with or without modification,
+must include the following acknowledgment:
+
+"This product includes software produced by UT-Battelle,
+LLC under Contract No. DE-AC05-00OR22725  with the
+Department of Energy."
+
+*********************************************************
+DISCLAIMER
+
+THE SOFTWARE IS SUPPLIED BY THE COPYRIGHT HOLDERS AND
+CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER, CONTRIBUTORS, UNITED STATES GOVERNMENT,
+OR THE UNITED STATES DEPARTMENT OF ENERGY BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+
+NEITHER THE UNITED STATES GOVERNMENT, NOR THE UNITED
+STATES DEPARTMENT OF ENERGY, NOR THE COPYRIGHT OWNER, NOR
+ANY OF THEIR EMPLOYEES, REPRESENTS THAT THE USE OF ANY
+INFORMATION, DATA, APPARATUS, PRODUCT, OR PROCESS
+DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+
+*********************************************************
+
+
+*/
+// END LICENSE BLOCK
+/** \ingroup DMRG */
+/*@{*/
+
+/*! \file GreensFunctionCache.h
+ *
+ * Single-particle Green's functions from an Engine's eigenbasis
+ *
+ * G(i,j;t) = sum_lambda U(i,lambda) exp(-i E_lambda t) U*(j,lambda)
+ * G(i,j;z) = sum_lambda U(i,lambda) U*(j,lambda)/(z - E_lambda)
+ *
+ * Matrices are computed with one GEMM the first time a time or a
+ * frequency is requested, and kept until the memory budget forces
+ * the least recently used ones out. The budget also covers the copy
+ * of the eigenvectors that the GEMM reads.
+ *
+ * A single row of G, as when one site is fixed, is better asked for
+ * with timeRow() or frequencyRow(): it costs O(n^2) instead of O(n^3)
+ * and is neither cached nor counted.
+ *
+ * Lookups are const: the cache itself is mutable state behind a mutex,
+ * so a const Engine can be shared by threads that all query it.
+ *
+ */
+#ifndef GREENS_FUNCTION_CACHE_H
+#define GREENS_FUNCTION_CACHE_H
+
+#include "Complex.h" // in PsimagLite
+#include "Matrix.h" // in PsimagLite
+#include "BLAS.h" // in PsimagLite
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace FreeFermions {
+
+// SourceType provides size(), eigenvalue(lambda) and eigenvector(i,lambda),
+// as Engine does
+template<typename RealType,typename FieldType,typename SourceType>
+class GreensFunctionCache {
+
+	enum KindEnum {KIND_TIME, KIND_FREQUENCY};
+
+	struct Key {
+
+		Key(KindEnum k, RealType r, RealType i)
+		    : kind(k), re(r), im(i)
+		{}
+
+		bool operator<(const Key& other) const
+		{
+			if (kind != other.kind) return (kind < other.kind);
+			if (re != other.re) return (re < other.re);
+			return (im < other.im);
+		}
+
+		KindEnum kind;
+		RealType re;
+		RealType im;
+	};
+
+public:
+
+	typedef std::complex<RealType> ComplexType;
+	typedef typename PsimagLite::Vector<ComplexType>::Type VectorComplexType;
+	typedef PsimagLite::Matrix<ComplexType> MatrixComplexType;
+	typedef std::shared_ptr<const MatrixComplexType> MatrixPointerType;
+
+	static const SizeType DEFAULT_BUDGET = 268435456; // 256 MB
+
+	GreensFunctionCache(const SourceType& source,
+	                    SizeType maxBytes = DEFAULT_BUDGET)
+	    : source_(source),
+	      maxBytes_(maxBytes),
+	      bytes_(0),
+	      hits_(0),
+	      misses_(0)
+	{}
+
+	// Holding on to the returned pointer keeps the matrix alive
+	// even if it is evicted meanwhile
+	MatrixPointerType time(RealType t) const
+	{
+		return get(Key(KIND_TIME, t, 0));
+	}
+
+	MatrixPointerType frequency(ComplexType z) const
+	{
+		return get(Key(KIND_FREQUENCY, PsimagLite::real(z), PsimagLite::imag(z)));
+	}
+
+	ComplexType time(SizeType i, SizeType j, RealType t) const
+	{
+		return time(t)->operator()(i, j);
+	}
+
+	ComplexType frequency(SizeType i, SizeType j, ComplexType z) const
+	{
+		return frequency(z)->operator()(i, j);
+	}
+
+	// row[j] = G(i,j;t)
+	void timeRow(VectorComplexType& row, SizeType i, RealType t) const
+	{
+		computeRow(row, i, Key(KIND_TIME, t, 0));
+	}
+
+	// row[j] = G(i,j;z)
+	void frequencyRow(VectorComplexType& row, SizeType i, ComplexType z) const
+	{
+		computeRow(row, i, Key(KIND_FREQUENCY, PsimagLite::real(z), PsimagLite::imag(z)));
+	}
+
+	void setMemoryBudget(SizeType maxBytes)
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+		maxBytes_ = maxBytes;
+		evict(0);
+	}
+
+	void clear()
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+		lru_.clear();
+		cache_.clear();
+		u_.clear();
+		bytes_ = 0;
+	}
+
+	SizeType bytes() const
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+		return bytes_;
+	}
+
+	SizeType hits() const
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+		return hits_;
+	}
+
+	SizeType misses() const
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+		return misses_;
+	}
+
+private:
+
+	typedef std::list<Key> ListType;
+	typedef std::pair<typename ListType::iterator, MatrixPointerType> EntryType;
+	typedef std::map<Key, EntryType> MapType;
+
+	MatrixPointerType get(const Key& key) const
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+		typename MapType::iterator it = cache_.find(key);
+		if (it != cache_.end()) {
+			++hits_;
+			lru_.splice(lru_.begin(), lru_, it->second.first);
+			return it->second.second;
+		}
+
+		++misses_;
+		MatrixPointerType ptr(compute(key));
+		// bytes_ already holds the copy of the eigenvectors, of the same size
+		SizeType entryBytes = matrixBytes();
+		if (2*entryBytes > maxBytes_) return ptr;
+
+		evict(entryBytes);
+		lru_.push_front(key);
+		cache_.insert(typename MapType::value_type(key, EntryType(lru_.begin(), ptr)));
+		bytes_ += entryBytes;
+		return ptr;
+	}
+
+	// makes room for extra bytes
+	void evict(SizeType extra) const
+	{
+		SizeType entryBytes = matrixBytes();
+		while (lru_.size() > 0 && bytes_ + extra > maxBytes_) {
+			cache_.erase(lru_.back());
+			lru_.pop_back();
+			bytes_ -= entryBytes;
+		}
+	}
+
+	// G = U f(E) U^dagger as a single GEMM
+	MatrixComplexType* compute(const Key& key) const
+	{
+		SizeType n = source_.size();
+		if (u_.n_row() != n) {
+			u_.resize(n, n);
+			for (SizeType i = 0; i < n; ++i)
+				for (SizeType j = 0; j < n; ++j)
+					u_(i, j) = source_.eigenvector(i, j);
+			bytes_ += matrixBytes();
+		}
+
+		MatrixComplexType w(n, n);
+		for (SizeType lambda = 0; lambda < n; ++lambda) {
+			ComplexType f = function(key, source_.eigenvalue(lambda));
+			for (SizeType i = 0; i < n; ++i)
+				w(i, lambda) = u_(i, lambda)*f;
+		}
+
+		MatrixComplexType* g = new MatrixComplexType(n, n);
+		if (n == 0) return g;
+		ComplexType alpha = 1.0;
+		ComplexType beta = 0.0;
+		psimag::BLAS::GEMM('N', 'C', n, n, n, alpha, &(w(0, 0)), n,
+		                   &(u_(0, 0)), n, beta, &((*g)(0, 0)), n);
+		return g;
+	}
+
+	// row[j] = sum_lambda U(i,lambda) f(E_lambda) U*(j,lambda), read
+	// straight from the source; touches no cached state, needs no lock
+	void computeRow(VectorComplexType& row, SizeType i, const Key& key) const
+	{
+		SizeType n = source_.size();
+		row.assign(n, 0.0);
+		for (SizeType lambda = 0; lambda < n; ++lambda) {
+			ComplexType w = source_.eigenvector(i, lambda)*
+			        function(key, source_.eigenvalue(lambda));
+			for (SizeType j = 0; j < n; ++j)
+				row[j] += w*PsimagLite::conj(source_.eigenvector(j, lambda));
+		}
+	}
+
+	static ComplexType function(const Key& key, RealType energy)
+	{
+		if (key.kind == KIND_FREQUENCY)
+			return 1.0/(ComplexType(key.re, key.im) - energy);
+
+		RealType exponent = -key.re*energy;
+		return ComplexType(cos(exponent), sin(exponent));
+	}
+
+	SizeType matrixBytes() const
+	{
+		SizeType n = source_.size();
+		return n*n*sizeof(ComplexType);
+	}
+
+	const SourceType& source_;
+	SizeType maxBytes_;
+	// everything below is guarded by mutex_
+	mutable SizeType bytes_;
+	mutable SizeType hits_;
+	mutable SizeType misses_;
+	mutable MatrixComplexType u_;
+	mutable ListType lru_;
+	mutable MapType cache_;
+	mutable std::mutex mutex_;
+}; // GreensFunctionCache
+} // namespace FreeFermions
+
+/*@}*/
+#endif // GREENS_FUNCTION_CACHE_H
@@ -82,8 +82,15 @@ DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
 
 #include "Complex.h" // in PsimagLite
 #include "FermionFactor.h"
+#include "WickDeterminant.h"
 #include "TypeToString.h"
 #include "Vector.h"
+#include "Matrix.h"
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
 
 namespace FreeFermions {
 struct OperatorPointer {
@@ -111,10 +118,26 @@ public:
 	DummyOperator(const DummyOperator* x) {}
 	template<typename T1>
 	FieldType operator()(const T1&,SizeType) const { return 1; }
+	template<typename T1>
+	FieldType weight(SizeType,SizeType) const { return 1; }
+	SizeType gridSize() const { return 1; }
+	template<typename T1>
+	void operator()(typename PsimagLite::Vector<FieldType>::Type& values,
+	                const T1&,
+	                SizeType) const { values.assign(1,1); }
 	SizeType sigma() const { return 0; }
 	void transpose() {}
 };
 
+// Number of terms evaluated and of branches cut by the enumeration
+// backend; share one per thread among states, see setCounters()
+struct EnumerationCounters {
+	EnumerationCounters() : visited(0),pruned(0) {}
+
+	SizeType visited;
+	SizeType pruned;
+};
+
 template<typename CorDOperatorType_,
          typename DiagonalOperatorType_=
          DummyOperator<typename CorDOperatorType_::FieldType> >
@@ -124,10 +147,42 @@ class HilbertState {
 	typedef typename CorDOperatorType_::FieldType FieldType;
 	typedef FermionFactor<CorDOperatorType_,OperatorPointer> FermionFactorType;
 	typedef typename FermionFactorType::FreeOperatorsType FreeOperatorsType;
-	typedef typename FreeOperatorsType::PermutationsType PermutationsType;
-	typedef typename FreeOperatorsType::IndexGeneratorType IndexGeneratorType;
+	typedef WickDeterminant<CorDOperatorType_,
+	DiagonalOperatorType_,
+	OperatorPointer> WickDeterminantType;
 
 	typedef HilbertState<CorDOperatorType_,DiagonalOperatorType_> ThisType;
+	typedef typename PsimagLite::Vector<SizeType>::Type VectorSizeType;
+	typedef typename PsimagLite::Vector<VectorSizeType>::Type VectorVectorSizeType;
+	typedef typename PsimagLite::Vector<FieldType>::Type VectorFieldType;
+	// terms of a state for one flavor, keyed by the sorted levels whose
+	// occupation differs from the state's occupations
+	typedef std::map<VectorSizeType,FieldType> ExpansionType;
+	typedef typename PsimagLite::Vector<ExpansionType>::Type VectorExpansionType;
+
+	struct DepthFirstType {
+		DepthFirstType(const VectorSizeType& occ,const VectorSizeType& occ2)
+		    : occupations(occ),
+		      occupations2(occ2),
+		      differences(0),
+		      visited(0),
+		      pruned(0),
+		      gridSums(0)
+		{}
+
+		VectorSizeType occupations;
+		const VectorSizeType& occupations2;
+		VectorSizeType middle;
+		VectorSizeType lambda;
+		VectorSizeType lambda2;
+		SizeType differences;
+		SizeType visited;
+		SizeType pruned;
+		// if set, terms are added here, one per grid point
+		VectorFieldType* gridSums;
+		VectorFieldType gridValues;
+		VectorFieldType gridScratch;
+	};
 
 	enum {CREATION = CorDOperatorType_::CREATION,
 		  DESTRUCTION = CorDOperatorType_::DESTRUCTION,
@@ -139,66 +194,191 @@ public:
 	typedef DiagonalOperatorType_ DiagonalOperatorType;
 	typedef typename CorDOperatorType::FactoryType OpNormalFactoryType;
 	typedef typename DiagonalOperatorType::FactoryType OpDiagonalFactoryType;
+	typedef typename PsimagLite::Vector<ThisType>::Type VectorThisType;
+
+	// ENUMERATION sums over all lambda indices and their permutations
+	// WICK computes a determinant of contractions, see WickDeterminant.h
+	enum class BackendEnum {ENUMERATION, WICK};
 
 	// it's the g.s. for now, FIXME change it later to allow more flex.
 	HilbertState(const EngineType& engine,
 	             const typename PsimagLite::Vector<SizeType>::Type& ne,
-	             bool debug = false)
+	             bool debug = false,
+	             BackendEnum backend = BackendEnum::ENUMERATION)
 	    : engine_(&engine),
 	      debug_(debug),
-	      occupations_(ne.size()),
-	      opNormalFactory_(engine),
-	      opDiagonalFactory_(engine)
+	      backend_(backend),
+	      counters_(0),
+	      lists_(std::make_shared<ListsType>()),
+	      interned_(std::make_shared<InternedType>(engine))
 	{
-		for (SizeType i=0;i<occupations_.size();++i) {
-			occupations_[i].resize(engine.size(),0);
+		checkAllLevels(engine);
+		std::shared_ptr<VectorVectorSizeType> occupations =
+		        std::make_shared<VectorVectorSizeType>(ne.size());
+		for (SizeType i=0;i<occupations->size();++i) {
+			(*occupations)[i].resize(engine.size(),0);
 			for (SizeType j=0;j<ne[i];++j) {
-				occupations_[i][j] = 1;
+				(*occupations)[i][j] = 1;
 			}
 		}
+
+		occupations_ = occupations;
 	}
 
 	HilbertState(const EngineType& engine,
 	             const typename PsimagLite::Vector<typename PsimagLite::Vector<SizeType>::Type >::Type& occupations,
-	             bool debug = false)
+	             bool debug = false,
+	             BackendEnum backend = BackendEnum::ENUMERATION)
 	    : engine_(&engine),
 	      debug_(debug),
-	      occupations_(occupations),
-	      opNormalFactory_(engine),
-	      opDiagonalFactory_(engine)
+	      backend_(backend),
+	      counters_(0),
+	      occupations_(std::make_shared<VectorVectorSizeType>(occupations)),
+	      lists_(std::make_shared<ListsType>()),
+	      interned_(std::make_shared<InternedType>(engine))
 	{
+		checkAllLevels(engine);
 	}
 
 	void pushInto(const CorDOperatorType& op)
 	{
 		if (op.type()==CREATION) {
+			ListsType& lists = mutableLists();
 			OperatorPointer opPointer(op.type(),op.sigma(),
-			                          operatorsCreation_.size());
-			operatorsCreation_.push_back(&op);
-			opPointers_.push_back(opPointer);
+			                          lists.operatorsCreation.size());
+			lists.operatorsCreation.push_back(&op);
+			lists.opPointers.push_back(opPointer);
 		} else if (op.type()==DESTRUCTION) {
+			ListsType& lists = mutableLists();
 			OperatorPointer opPointer(op.type(),op.sigma(),
-			                          operatorsDestruction_.size());
-			operatorsDestruction_.push_back(&op);
-			opPointers_.push_back(opPointer);
+			                          lists.operatorsDestruction.size());
+			lists.operatorsDestruction.push_back(&op);
+			lists.opPointers.push_back(opPointer);
 		}
 	}
 
 	void pushInto(const DiagonalOperatorType& op)
 	{
+		ListsType& lists = mutableLists();
 		OperatorPointer opPointer(DIAGONAL,0,
-		                          operatorsDiagonal_.size());
-		operatorsDiagonal_.push_back(&op);
-		opPointers_.push_back(opPointer);
+		                          lists.operatorsDiagonal.size());
+		lists.operatorsDiagonal.push_back(&op);
+		lists.opPointers.push_back(opPointer);
 	}
 
 	FieldType pourAndClose(const ThisType& hs)
 	{
 		pour(hs);
-		return close(hs.occupations_);
+		return close(*hs.occupations_);
+	}
+
+	// values[k] is pourAndClose(hs) with every diagonal operator
+	// evaluated at point k of its grid, all in one enumeration
+	void pourAndClose(VectorFieldType& values,const ThisType& hs)
+	{
+		pour(hs);
+		close(values,*hs.occupations_);
+	}
+
+	// points of the diagonal operators' grid; those without
+	// one (size 1) take the same value at every point
+	SizeType gridSize() const
+	{
+		SizeType n = 1;
+		for (SizeType i=0;i<lists_->operatorsDiagonal.size();i++) {
+			SizeType m = lists_->operatorsDiagonal[i]->gridSize();
+			if (m==1 || m==n) continue;
+			if (n>1)
+				throw PsimagLite::RuntimeError("HilbertState: grids of different sizes\n");
+			n = m;
+		}
+
+		return n;
+	}
+
+	void setBackend(BackendEnum backend) { backend_ = backend; }
+
+	// copies of this state, scalarProduct's included, add to *counters
+	void setCounters(EnumerationCounters* counters) { counters_ = counters; }
+
+	BackendEnum backend() const { return backend_; }
+
+	// overlaps[b] = <bras[b]|this>, as scalarProduct(bras[b],*this) gives.
+	// This ket is expanded once in the eigenbasis and each bra once,
+	// so the ket's work is shared by all bras, whatever the backend
+	void scalarProducts(VectorFieldType& overlaps,const VectorThisType& bras) const
+	{
+		VectorExpansionType ketTerms;
+		expand(ketTerms);
+		overlaps.resize(bras.size());
+		VectorExpansionType braTerms;
+		for (SizeType b=0;b<bras.size();b++) {
+			bras[b].expand(braTerms);
+			overlaps[b] = overlap(braTerms,bras[b],ketTerms);
+		}
+	}
+
+	// m(i,j) = <bras[i]|kets[j]>, expanding each state once
+	static void scalarProducts(PsimagLite::Matrix<FieldType>& m,
+	                           const VectorThisType& bras,
+	                           const VectorThisType& kets)
+	{
+		typename PsimagLite::Vector<VectorExpansionType>::Type braTerms(bras.size());
+		for (SizeType i=0;i<bras.size();i++)
+			bras[i].expand(braTerms[i]);
+
+		m.resize(bras.size(),kets.size());
+		VectorExpansionType ketTerms;
+		for (SizeType j=0;j<kets.size();j++) {
+			// the bras may be the kets, as for a matrix of overlaps
+			if (&bras != &kets) kets[j].expand(ketTerms);
+			const VectorExpansionType& terms = (&bras == &kets) ? braTerms[j] : ketTerms;
+			for (SizeType i=0;i<bras.size();i++)
+				m(i,j) = kets[j].overlap(braTerms[i],bras[i],terms);
+		}
 	}
 
 private:
+	struct ListsType {
+		typename PsimagLite::Vector<const CorDOperatorType*>::Type operatorsCreation,operatorsDestruction;
+		typename PsimagLite::Vector<const DiagonalOperatorType*>::Type operatorsDiagonal;
+		typename PsimagLite::Vector<OperatorPointer>::Type opPointers;
+	};
+
+	// Transposes of this engine's operators, interned by (type, site, sigma)
+	// and shared by a state and all its copies, which may pour in
+	// different threads
+	struct InternedType {
+		InternedType(const EngineType& engine)
+		    : opNormalFactory(engine)
+		{}
+
+		OpNormalFactoryType opNormalFactory;
+		std::mutex mutex;
+	};
+
+	// Transposed copies of diagonal operators and of operators on other
+	// engines, which cannot be interned; they belong to the state that
+	// poured them
+	struct FactoriesType {
+		FactoriesType(const EngineType& engine,
+		              const std::shared_ptr<FactoriesType>& prev)
+		    : opNormalFactory(engine),opDiagonalFactory(engine),previous(prev)
+		{}
+
+		OpNormalFactoryType opNormalFactory;
+		OpDiagonalFactoryType opDiagonalFactory;
+		std::shared_ptr<FactoriesType> previous;
+	};
+
+	// the enumeration runs over every level
+	static void checkAllLevels(const EngineType& engine)
+	{
+		if (engine.levels() == engine.size()) return;
+		throw PsimagLite::RuntimeError("HilbertState: needs all levels of the Engine,"
+		                               " not given with Levels= or Window=\n");
+	}
+
 	void pour(const ThisType& hs)
 	{
 		if (hs.engine_->size()!=engine_->size()) {
@@ -219,17 +399,39 @@ private:
 
 	FieldType close(const typename PsimagLite::Vector<typename PsimagLite::Vector<SizeType>::Type >::Type& occupations2) const
 	{
-		//std::cerr<<"DEBUG: closing with weight="<<opPointers_.size()<<"\n";
+		//std::cerr<<"DEBUG: closing with weight="<<lists_->opPointers.size()<<"\n";
 		FieldType prod = 1.0;
-		if (occupations_.size()!=occupations2.size())
+		if (occupations_->size()!=occupations2.size())
 			throw std::runtime_error("HilbertState::close()\n");
 
-		for (SizeType i=0;i<occupations_.size();i++) {
+		for (SizeType i=0;i<occupations_->size();i++) {
 			prod *= close(i,occupations2[i]);
 		}
 		return prod; // FIXME: NEEDS FERMION SIGN
 	}
 
+	void close(VectorFieldType& values,const VectorVectorSizeType& occupations2) const
+	{
+		if (occupations_->size()!=occupations2.size())
+			throw std::runtime_error("HilbertState::close()\n");
+		if (backend_ == BackendEnum::WICK)
+			throw PsimagLite::RuntimeError("HilbertState: grids need ENUMERATION\n");
+
+		SizeType n = gridSize();
+		values.assign(n,1.0);
+		VectorFieldType sums(n);
+		for (SizeType sigma=0;sigma<occupations_->size();sigma++) {
+			std::fill(sums.begin(),sums.end(),0.0);
+			DepthFirstType dfs((*occupations_)[sigma],occupations2[sigma]);
+			setDepthFirst(dfs,sigma);
+			dfs.gridSums = &sums;
+			depthFirst(dfs,0,0,0,1.0,sigma);
+			addToCounters(dfs);
+			for (SizeType k=0;k<n;k++)
+				values[k] *= sums[k];
+		}
+	}
+
 	bool equalZero(const typename PsimagLite::Vector<typename PsimagLite::Vector<SizeType>::Type >::Type& v) const
 	{
 		for (SizeType i=0;i<v.size();i++)
@@ -245,129 +447,362 @@ private:
 
 	FieldType close(SizeType sigma,const typename PsimagLite::Vector<SizeType>::Type& occupations2) const
 	{
-		SizeType m = findCreationGivenSpin(sigma);
-		IndexGeneratorType lambda(m,engine_->size());
-		FieldType sum  = 0;
-		do {
-			sum += compute(lambda,sigma,occupations2);
-		} while (lambda.increase());
+		if (backend_ == BackendEnum::WICK) {
+			WickDeterminantType wick(*engine_,
+			                         lists_->opPointers,
+			                         lists_->operatorsCreation,
+			                         lists_->operatorsDestruction,
+			                         lists_->operatorsDiagonal);
+			return wick(sigma,(*occupations_)[sigma],occupations2);
+		}
+
+		DepthFirstType dfs((*occupations_)[sigma],occupations2);
+		setDepthFirst(dfs,sigma);
+		FieldType sum = depthFirst(dfs,0,0,0,1.0,sigma);
+		addToCounters(dfs);
 		return sum;
 	}
 
-	SizeType findCreationGivenSpin(SizeType sigma) const
+	void setDepthFirst(DepthFirstType& dfs,SizeType sigma) const
 	{
-		SizeType counter = 0;
-		for (SizeType i=0;i<opPointers_.size();i++) {
-			if (opPointers_[i].type == CREATION &&
-			        opPointers_[i].sigma == sigma) counter++;
+		for (SizeType i=0;i<lists_->opPointers.size();i++) {
+			SizeType type = lists_->opPointers[i].type;
+			if (type!=CREATION && type!=DESTRUCTION) continue;
+			if (lists_->opPointers[i].sigma!=sigma) continue;
+			dfs.middle.push_back(i);
+			if (type==CREATION)
+				dfs.lambda.push_back(0);
+			else
+				dfs.lambda2.push_back(0);
 		}
-		return counter;
+
+		for (SizeType i=0;i<dfs.occupations.size();i++)
+			if (dfs.occupations[i]!=dfs.occupations2[i]) dfs.differences++;
 	}
 
-	FieldType compute(const IndexGeneratorType& lambda,
-	                  SizeType sigma,
-	                  const typename PsimagLite::Vector<SizeType>::Type& occupations2) const
+	void addToCounters(const DepthFirstType& dfs) const
 	{
+		if (!counters_) return;
+		counters_->visited += dfs.visited;
+		counters_->pruned += dfs.pruned;
+	}
 
-		PermutationsType lambda2(lambda);
-		FieldType sum = 0;
-		do  {
-			FieldType prod = 1;
-			FreeOperatorsType lambdaOperators(opPointers_,lambda,lambda2,
-			                                  sigma,occupations_[sigma],occupations2);
-			// diag. part need to be done here, because...
-			FieldType dd = 1.0;
-			for (SizeType i=0;i<operatorsDiagonal_.size();i++) {
-				SizeType loc = lambdaOperators.findLocOfDiagOp(i);
-				dd *= operatorsDiagonal_[i]->operator()(lambdaOperators,loc);
+	// Assigns lambdas to the operators of flavor sigma in the order
+	// they were applied, following the occupations as it goes.
+	// A creation is only tried on an empty level and a destruction
+	// on an occupied one, and a branch is cut as soon as the
+	// operators left cannot turn the occupations into occupations2.
+	FieldType depthFirst(DepthFirstType& dfs,
+	                     SizeType level,
+	                     SizeType c,
+	                     SizeType d,
+	                     FieldType prod,
+	                     SizeType sigma) const
+	{
+		SizeType remaining = dfs.middle.size() - level;
+		if (dfs.differences>remaining || ((remaining - dfs.differences) & 1)) {
+			dfs.pruned++;
+			return 0.0;
+		}
+
+		if (remaining==0) {
+			dfs.visited++;
+			return compute(dfs,prod,sigma);
+		}
+
+		const OperatorPointer& opPointer = lists_->opPointers[dfs.middle[level]];
+		bool isCreation = (opPointer.type==CREATION);
+		const CorDOperatorType* op = (isCreation) ?
+		            lists_->operatorsCreation[opPointer.index] :
+		            lists_->operatorsDestruction[opPointer.index];
+		SizeType occupied = (isCreation) ? 0 : 1;
+		FieldType sum = 0.0;
+		for (SizeType lambda=0;lambda<dfs.occupations.size();lambda++) {
+			if (dfs.occupations[lambda]!=occupied) {
+				dfs.pruned++;
+				continue;
 			}
-			// ... fermionFactor ctor will modify lambdaOperators
 
-			FermionFactorType fermionFactor(lambdaOperators);
-			RealType ff = fermionFactor();
+			bool wasDifferent = (dfs.occupations[lambda]!=dfs.occupations2[lambda]);
+			dfs.occupations[lambda] = 1 - occupied;
+			if (wasDifferent)
+				dfs.differences--;
+			else
+				dfs.differences++;
+
+			if (isCreation)
+				dfs.lambda[c] = lambda;
+			else
+				dfs.lambda2[d] = lambda;
+
+			FieldType value = prod*op->operator()(lambda);
+			sum += depthFirst(dfs,
+			                  level+1,
+			                  (isCreation) ? c+1 : c,
+			                  (isCreation) ? d : d+1,
+			                  value,
+			                  sigma);
+
+			dfs.occupations[lambda] = occupied;
+			if (wasDifferent)
+				dfs.differences++;
+			else
+				dfs.differences--;
+		}
 
-			if (fabs(ff)<1e-6) continue;
-			for (SizeType i=0;i<lambda.size();i++) {
-				int loc = findLocOf(operatorsCreation_,i,sigma);
-				if (loc<0) continue;
-				assert(static_cast<SizeType>(loc) < operatorsCreation_.size());
-				prod *= operatorsCreation_[loc]->operator()(lambda[i]);
+		return sum;
+	}
+
+	FieldType compute(DepthFirstType& dfs,
+	                  FieldType prod,
+	                  SizeType sigma) const
+	{
+		FreeOperatorsType lambdaOperators(lists_->opPointers,dfs.lambda,dfs.lambda2,
+		                                  sigma,(*occupations_)[sigma],dfs.occupations2);
+		// diag. part need to be done here, because...
+		FieldType dd = 1.0;
+		if (dfs.gridSums)
+			dfs.gridValues.assign(dfs.gridSums->size(),1.0);
+		for (SizeType i=0;i<lists_->operatorsDiagonal.size();i++) {
+			SizeType loc = lambdaOperators.findLocOfDiagOp(i);
+			const DiagonalOperatorType* op = lists_->operatorsDiagonal[i];
+			if (!dfs.gridSums || op->gridSize()==1) {
+				dd *= op->operator()(lambdaOperators,loc);
+				continue;
 			}
-			for (SizeType i=0;i<lambda2.size();i++) {
-				int loc = findLocOf(operatorsDestruction_,i,sigma);
-				if (loc<0) continue;
-				prod *= operatorsDestruction_[loc]->operator()(lambda2[i]);
+
+			op->operator()(dfs.gridScratch,lambdaOperators,loc);
+			for (SizeType k=0;k<dfs.gridValues.size();k++)
+				dfs.gridValues[k] *= dfs.gridScratch[k];
+		}
+		// ... fermionFactor ctor will modify lambdaOperators
+
+		FermionFactorType fermionFactor(lambdaOperators);
+		RealType ff = fermionFactor();
+
+		if (debug_) {
+			std::cerr<<" lambda=";
+			for (SizeType i=0;i<dfs.lambda.size();i++) std::cerr<<dfs.lambda[i]<<" ";
+			std::cerr<<" lambda2=";
+			for (SizeType i=0;i<dfs.lambda2.size();i++) std::cerr<<dfs.lambda2[i]<<" ";
+			std::cerr<<" ff="<<ff<<" dd="<<dd<<" prod="<<prod<<"\n";
+		}
+
+		if (fabs(ff)<1e-6) return 0.0;
+		if (dfs.gridSums) {
+			FieldType factor = prod*ff*dd;
+			for (SizeType k=0;k<dfs.gridValues.size();k++)
+				(*dfs.gridSums)[k] += factor*dfs.gridValues[k];
+			return 0.0;
+		}
+
+		return prod*ff*dd;
+	}
+
+	// The state as a sum of terms c^dagger_{lambda_max}...c^dagger_{lambda_min}|0>
+	// for each flavor, applying the operators in order; diagonal operators
+	// are evaluated on each term, for each flavor, as close() does
+	void expand(VectorExpansionType& expansion) const
+	{
+		expansion.resize(occupations_->size());
+		for (SizeType sigma=0;sigma<expansion.size();sigma++)
+			expand(expansion[sigma],sigma);
+	}
+
+	void expand(ExpansionType& terms,SizeType sigma) const
+	{
+		const VectorSizeType& occupations = (*occupations_)[sigma];
+		SizeType n = occupations.size();
+		// above[lambda] = levels occupied in occupations above lambda
+		VectorSizeType above(n,0);
+		for (SizeType i=1;i<n;i++)
+			above[n-i-1] = above[n-i] + occupations[n-i];
+
+		terms.clear();
+		terms[VectorSizeType()] = 1.0;
+		ExpansionType next;
+		for (SizeType i=0;i<lists_->opPointers.size();i++) {
+			const OperatorPointer& opPointer = lists_->opPointers[i];
+			if (opPointer.type==DIAGONAL) {
+				applyDiagonal(terms,*lists_->operatorsDiagonal[opPointer.index],sigma);
+				continue;
 			}
-			if (debug_) {
-				std::cerr<<" lambda="<<lambda;
-				std::cerr<<" lambda2="<<lambda2;
-				std::cerr<<" ff="<<ff<<" dd="<<dd<<" prod="<<prod;
-				std::cerr<<"sum ="<<sum<<"\n";
+
+			if (opPointer.sigma!=sigma) continue;
+			bool isCreation = (opPointer.type==CREATION);
+			const CorDOperatorType* op = (isCreation) ?
+			            lists_->operatorsCreation[opPointer.index] :
+			            lists_->operatorsDestruction[opPointer.index];
+			next.clear();
+			typename ExpansionType::const_iterator it = terms.begin();
+			for (;it!=terms.end();++it) {
+				const VectorSizeType& flips = it->first;
+				for (SizeType lambda=0;lambda<n;lambda++) {
+					bool flipped = std::binary_search(flips.begin(),flips.end(),lambda);
+					bool occupied = ((occupations[lambda]!=0) != flipped);
+					if (occupied==isCreation) continue;
+
+					// sign of moving the operator past the levels occupied above
+					// lambda; each flip above changes their number by one
+					SizeType sign = above[lambda] + (flips.end() -
+					        std::upper_bound(flips.begin(),flips.end(),lambda));
+
+					VectorSizeType key = flips;
+					if (flipped)
+						key.erase(std::lower_bound(key.begin(),key.end(),lambda));
+					else
+						key.insert(std::upper_bound(key.begin(),key.end(),lambda),lambda);
+
+					FieldType value = it->second*op->operator()(lambda);
+					next[key] += (sign & 1) ? -value : value;
+				}
 			}
-			sum += prod*ff*dd;
 
-		} while(lambda2.increase());
-		return sum;
+			terms.swap(next);
+		}
 	}
 
-	int findLocOf(
-	        const typename PsimagLite::Vector<const CorDOperatorType*>::Type& v,
-	        SizeType ind,
-	        SizeType sigma) const
+	// multiplies each term by op evaluated on its occupations
+	void applyDiagonal(ExpansionType& terms,
+	                   const DiagonalOperatorType& op,
+	                   SizeType sigma) const
 	{
-		SizeType counter = 0;
-		for (SizeType i=0;i<v.size();i++) {
-			if (v[i]->sigma() != sigma) continue;
-			if (counter==ind) return i;
-			counter++;
+		if (op.gridSize()!=1)
+			throw PsimagLite::RuntimeError("HilbertState::scalarProducts(): no grids\n");
+
+		typename PsimagLite::Vector<OperatorPointer>::Type opPointers(1,OperatorPointer(DIAGONAL,0,0));
+		VectorSizeType noLambdas;
+		typename ExpansionType::iterator it = terms.begin();
+		for (;it!=terms.end();++it) {
+			VectorSizeType occupations = (*occupations_)[sigma];
+			for (SizeType i=0;i<it->first.size();i++)
+				occupations[it->first[i]] = 1 - occupations[it->first[i]];
+			FreeOperatorsType freeOps(opPointers,noLambdas,noLambdas,sigma,occupations,occupations);
+			it->second *= op(freeOps,freeOps.findLocOfDiagOp(0));
 		}
-		return -1;
+	}
+
+	// <bra|this> from the expansions of both; zero if their fillings
+	// differ, as the enumeration backend gives
+	FieldType overlap(const VectorExpansionType& braTerms,
+	                  const ThisType& bra,
+	                  const VectorExpansionType& ketTerms) const
+	{
+		if (bra.occupations_->size()!=occupations_->size() ||
+		        bra.engine_->size()!=engine_->size())
+			throw PsimagLite::RuntimeError("HilbertState::scalarProducts()\n");
+
+		FieldType prod = 1.0;
+		for (SizeType sigma=0;sigma<occupations_->size();sigma++) {
+			const VectorSizeType& occupations = (*occupations_)[sigma];
+			const VectorSizeType& occupations2 = (*bra.occupations_)[sigma];
+			VectorSizeType differ;
+			SizeType filling = 0;
+			SizeType filling2 = 0;
+			for (SizeType lambda=0;lambda<occupations.size();lambda++) {
+				filling += occupations[lambda];
+				filling2 += occupations2[lambda];
+				if (occupations[lambda]!=occupations2[lambda]) differ.push_back(lambda);
+			}
+
+			if (filling!=filling2) return 0.0;
+
+			// keys of the bra are relative to occupations2, make them relative to occupations
+			FieldType sum = 0.0;
+			VectorSizeType key;
+			typename ExpansionType::const_iterator it = braTerms[sigma].begin();
+			for (;it!=braTerms[sigma].end();++it) {
+				key.clear();
+				std::set_symmetric_difference(it->first.begin(),it->first.end(),
+				                              differ.begin(),differ.end(),
+				                              std::back_inserter(key));
+				typename ExpansionType::const_iterator found = ketTerms[sigma].find(key);
+				if (found==ketTerms[sigma].end()) continue;
+				sum += PsimagLite::conj(it->second)*found->second;
+			}
+
+			prod *= sum;
+		}
+
+		return prod;
 	}
 
 	void pourInternal(const ThisType& hs)
 	{
+		// hs may share its lists with this state, so hold on to them
+		std::shared_ptr<const ListsType> other = hs.lists_;
 		SizeType counter = 0;
 		SizeType counter2 = 0;
 		SizeType counter3 = 0;
-		SizeType n1 = hs.opPointers_.size();
+		SizeType n1 = other->opPointers.size();
 		// pour them in reverse order:
-		for (SizeType i=0;i<hs.opPointers_.size();i++) {
-			if (hs.opPointers_[n1-i-1].type==CREATION) {
-				SizeType x1 = hs.operatorsCreation_.size() - 1 - counter;
-				assert(x1 < hs.operatorsCreation_.size());
-				const CorDOperatorType* op = hs.operatorsCreation_[x1];
+		for (SizeType i=0;i<other->opPointers.size();i++) {
+			if (other->opPointers[n1-i-1].type==CREATION) {
+				SizeType x1 = other->operatorsCreation.size() - 1 - counter;
+				assert(x1 < other->operatorsCreation.size());
+				const CorDOperatorType* op = other->operatorsCreation[x1];
 				counter++;
-				CorDOperatorType& opCopy = opNormalFactory_(op);
-				opCopy.transpose();
-				pushInto(opCopy);
-			} else if (hs.opPointers_[n1-i-1].type==DESTRUCTION) {
-				SizeType x2 = hs.operatorsDestruction_.size() - 1 - counter2;
-				const CorDOperatorType* op = hs.operatorsDestruction_[x2];
+				pushInto(transposed(*op));
+			} else if (other->opPointers[n1-i-1].type==DESTRUCTION) {
+				SizeType x2 = other->operatorsDestruction.size() - 1 - counter2;
+				const CorDOperatorType* op = other->operatorsDestruction[x2];
 				counter2++;
-				CorDOperatorType& opCopy = opNormalFactory_(op);
-				opCopy.transpose();
-				pushInto(opCopy);
+				pushInto(transposed(*op));
 			} else {
-				SizeType x3 = hs.operatorsDiagonal_.size() - 1 - counter3;
-				const DiagonalOperatorType* op = hs.operatorsDiagonal_[x3];
+				SizeType x3 = other->operatorsDiagonal.size() - 1 - counter3;
+				const DiagonalOperatorType* op = other->operatorsDiagonal[x3];
 				counter3++;
-				DiagonalOperatorType& opCopy = opDiagonalFactory_(op);
+				DiagonalOperatorType& opCopy = mutableFactories().opDiagonalFactory(op);
 				opCopy.transpose();
 				pushInto(opCopy);
 			}
 		}
 	}
 
+	// The transpose of op is interned, so that pouring the same operators
+	// again allocates nothing; an op built on another engine, as in
+	// decay.cpp, is copied and transposed instead, so that it keeps
+	// its eigenvectors
+	const CorDOperatorType& transposed(const CorDOperatorType& op)
+	{
+		if (&op.engine() == engine_) {
+			SizeType type = (op.type()==CREATION) ? DESTRUCTION : CREATION;
+			std::lock_guard<std::mutex> guard(interned_->mutex);
+			return interned_->opNormalFactory(type,op.index(),op.sigma());
+		}
+
+		CorDOperatorType& opCopy = mutableFactories().opNormalFactory(&op);
+		opCopy.transpose();
+		return opCopy;
+	}
+
+	// Copies of a state share its lists; the first write clones them
+	ListsType& mutableLists()
+	{
+		if (lists_.use_count()>1)
+			lists_ = std::make_shared<ListsType>(*lists_);
+		return *lists_;
+	}
+
+	// Factories for copies are built on demand.
+	// Those shared with other copies are not written to; a new one
+	// is chained in front of them instead, keeping their operators alive
+	FactoriesType& mutableFactories()
+	{
+		if (!factories_ || factories_.use_count()>1)
+			factories_ = std::make_shared<FactoriesType>(*engine_,factories_);
+		return *factories_;
+	}
+
 	const EngineType* engine_;
 	bool debug_;
-	typename PsimagLite::Vector<PsimagLite::Vector<SizeType>::Type>::Type occupations_;
-	// 		typename PsimagLite::Vector<SizeType>::Type ne_;
-	// 		typename PsimagLite::Vector<SizeType>::Type ne2_;
-	typename PsimagLite::Vector<const CorDOperatorType*>::Type operatorsCreation_,operatorsDestruction_;
-	typename PsimagLite::Vector<const DiagonalOperatorType*>::Type operatorsDiagonal_;
-	typename PsimagLite::Vector<OperatorPointer>::Type opPointers_;
-	OpNormalFactoryType opNormalFactory_;
-	OpDiagonalFactoryType opDiagonalFactory_;
+	BackendEnum backend_;
+	EnumerationCounters* counters_;
+	// occupations never change, the lists are copied on write
+	std::shared_ptr<const VectorVectorSizeType> occupations_;
+	std::shared_ptr<ListsType> lists_;
+	std::shared_ptr<InternedType> interned_;
+	std::shared_ptr<FactoriesType> factories_;
 }; // HilbertState
 
 template<typename CorDOperatorType,typename DiagonalOperatorType>
@@ -379,6 +814,17 @@ typename CorDOperatorType::FieldType scalarProduct(
 	return s3.pourAndClose(s1);
 }
 
+// values[k] = <s1|s2> at point k of the grid of their diagonal operators,
+// e.g., at each time of an EToTheIhTime built with a vector of times
+template<typename CorDOperatorType,typename DiagonalOperatorType>
+void scalarProduct(typename PsimagLite::Vector<typename CorDOperatorType::FieldType>::Type& values,
+                   const HilbertState<CorDOperatorType,DiagonalOperatorType>& s1,
+                   const HilbertState<CorDOperatorType,DiagonalOperatorType>& s2)
+{
+	HilbertState<CorDOperatorType,DiagonalOperatorType> s3 = s2;
+	s3.pourAndClose(values,s1);
+}
+
 } // namespace Dmrg
 
 /*@}*/
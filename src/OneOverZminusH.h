@@ -88,6 +88,9 @@ public:
 	typedef EngineType_ EngineType;
 	typedef typename EngineType::RealType RealType;
 	typedef typename EngineType::FieldType FieldType;
+	typedef typename PsimagLite::Vector<RealType>::Type VectorRealType;
+	typedef typename PsimagLite::Vector<FieldType>::Type VectorFieldType;
+	typedef std::complex<RealType> ComplexType;
 
 	OneOverZminusH(FieldType z,
 	               int sign,
@@ -99,9 +102,106 @@ public:
 	      engine_(engine)
 	{}
 
+	// A grid of z = omegas[k] + i*broadenings[k], see operator()(values,...)
+	OneOverZminusH(const VectorRealType& omegas,
+	               const VectorRealType& broadenings,
+	               int sign,
+	               const RealType& offset,
+	               const EngineType& engine)
+	    : z_(0.0),
+	      omegas_(omegas),
+	      broadenings_(broadenings),
+	      sign_(sign),
+	      offset_(offset),
+	      engine_(engine)
+	{
+		if (omegas_.size()==0 || omegas_.size()!=broadenings_.size())
+			throw PsimagLite::RuntimeError("OneOverZminusH: omegas and broadenings\n");
+		assign(z_,ComplexType(omegas_[0],broadenings_[0]));
+	}
+
+	// Same broadening at every omega
+	OneOverZminusH(const VectorRealType& omegas,
+	               RealType broadening,
+	               int sign,
+	               const RealType& offset,
+	               const EngineType& engine)
+	    : z_(0.0),
+	      omegas_(omegas),
+	      broadenings_(omegas.size(),broadening),
+	      sign_(sign),
+	      offset_(offset),
+	      engine_(engine)
+	{
+		if (omegas_.size()==0)
+			throw PsimagLite::RuntimeError("OneOverZminusH: empty grid of omegas\n");
+		assign(z_,ComplexType(omegas_[0],broadenings_[0]));
+	}
+
 	template<typename FreeOperatorsType>
 	FieldType operator()(const FreeOperatorsType& freeOps,
 	                     SizeType loc) const
+	{
+		if (omegas_.size()>1)
+			throw PsimagLite::RuntimeError("OneOverZminusH: grid needs values\n");
+
+		//if (fabs(time_)>1000.0) return sum;
+		return 1.0/(z_-pole(freeOps,loc));
+	}
+
+	SizeType gridSize() const { return (omegas_.size()>1) ? omegas_.size() : 1; }
+
+	// values[k] is operator() at point k of the grid; the pole is
+	// found once and each point costs one complex division
+	template<typename FreeOperatorsType>
+	void operator()(VectorFieldType& values,
+	                const FreeOperatorsType& freeOps,
+	                SizeType loc) const
+	{
+		SizeType n = gridSize();
+		values.resize(n);
+		if (n==1) {
+			values[0] = operator()(freeOps,loc);
+			return;
+		}
+
+		RealType p = pole(freeOps,loc);
+		for (SizeType k=0;k<n;k++) {
+			RealType re = omegas_[k] - p;
+			RealType im = broadenings_[k];
+			RealType den = re*re + im*im;
+			assign(values[k],ComplexType(re/den,-im/den));
+		}
+	}
+
+	// the resolvent does not factorize into one weight per operator
+	template<typename FreeOperatorsType>
+	FieldType weight(SizeType, SizeType) const
+	{
+		throw PsimagLite::RuntimeError("OneOverZminusH::weight(): not factorizable\n");
+	}
+
+	void transpose()
+	{
+		z_ = PsimagLite::conj(z_);
+		for (SizeType k=0;k<broadenings_.size();k++)
+			broadenings_[k] = -broadenings_[k];
+	}
+
+private:
+
+	static void assign(ComplexType& dest,const ComplexType& src) { dest = src; }
+
+	// a real FieldType holds the grid only without broadening
+	static void assign(RealType& dest,const ComplexType& src)
+	{
+		if (PsimagLite::imag(src)!=0)
+			throw PsimagLite::RuntimeError("OneOverZminusH: real FieldType needs zero broadening\n");
+		dest = PsimagLite::real(src);
+	}
+
+	template<typename FreeOperatorsType>
+	RealType pole(const FreeOperatorsType& freeOps,SizeType loc) const
 	{
 		RealType sum = 0;
 		for (SizeType i=0;i<loc;i++) {
@@ -112,15 +212,13 @@ public:
 			             FreeOperatorsType::CREATION) ? -1 : 1;
 			sum += engine_.eigenvalue(freeOps[i].lambda)*sign;
 		}
-		//if (fabs(time_)>1000.0) return sum;
-		return 1.0/(z_-sign_*(sum+offset_));
-	}
 
-	void transpose() { z_ = PsimagLite::conj(z_); }
-
-private:
+		return sign_*(sum+offset_);
+	}
 
 	FieldType z_;
+	VectorRealType omegas_;
+	VectorRealType broadenings_;
 	int sign_;
 	RealType offset_;
 	const EngineType& engine_;
@@ -79,62 +79,147 @@ DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
 #ifndef OPERATOR_FACTORY_H
 #define OPERATOR_FACTORY_H
 #include "Concurrency.h"
+#include <new>
+#include <type_traits>
 
 namespace FreeFermions {
 
+// Objects are placed in a bump arena, one per thread, and all
+// destroyed together with the factory.
+// Operators requested by (type, site, sigma) are interned: asking
+// again in the same thread returns the same object, so they must
+// not be modified. Copies made from pointers or from backends are
+// never shared and may be modified, e.g., transposed.
 template<typename OpType>
 class OperatorFactory {
 	typedef typename OpType::EngineType EngineType;
 	typedef OperatorFactory<OpType> ThisType;
-	typedef typename PsimagLite::Vector<OpType*>::Type GarbageType;
+	typedef typename std::aligned_storage<sizeof(OpType),
+	alignof(OpType)>::type StorageType;
+
+	enum {BLOCK_SIZE = 64};
+
+	class Arena {
+
+	public:
+
+		Arena() : used_(BLOCK_SIZE) {}
+
+		~Arena()
+		{
+			for (SizeType i=0;i<blocks_.size();i++) {
+				SizeType n = (i+1==blocks_.size()) ? used_ : SizeType(BLOCK_SIZE);
+				for (SizeType j=0;j<n;j++)
+					reinterpret_cast<OpType*>(blocks_[i]+j)->~OpType();
+				delete [] blocks_[i];
+			}
+		}
+
+		// storage for the next object; call commit() once it's built
+		void* next()
+		{
+			if (used_==BLOCK_SIZE) {
+				blocks_.push_back(new StorageType[BLOCK_SIZE]);
+				used_ = 0;
+			}
+
+			return blocks_.back() + used_;
+		}
+
+		OpType* commit(OpType* op)
+		{
+			used_++;
+			return op;
+		}
+
+		SizeType size() const
+		{
+			return (blocks_.size()==0) ? 0 : (blocks_.size()-1)*BLOCK_SIZE + used_;
+		}
+
+	private:
+
+		Arena(const Arena&);
+
+		Arena& operator=(const Arena&);
+
+		typename PsimagLite::Vector<StorageType*>::Type blocks_;
+		SizeType used_;
+	}; // Arena
+
+	struct PerThreadType {
+		Arena arena;
+		// indexed by (x*size + site)*dof + sigma, grows as needed
+		typename PsimagLite::Vector<OpType*>::Type interned;
+	};
 
 public:
 
 	OperatorFactory(const EngineType& engine)
 	    : engine_(&engine),
-	      garbage_(PsimagLite::Concurrency::codeSectionParams.npthreads)
+	      perThread_(PsimagLite::Concurrency::codeSectionParams.npthreads)
 	{}
 
-	~OperatorFactory()
-	{
-		for (SizeType i=0;i<garbage_.size();i++)
-			for (SizeType j=0;j<garbage_[i].size(); ++j)
-				delete garbage_[i][j];
-	}
-
 	OpType& operator()(SizeType x,
 	                   SizeType site,
 	                   SizeType sigma,
 	                   SizeType threadId = 0)
 	{
-		OpType* op = new OpType(*engine_,x,site,sigma);
-		garbage_[threadId].push_back(op);
+		assert(threadId < perThread_.size());
+		PerThreadType& perThread = perThread_[threadId];
+		SizeType index = (x*engine_->size() + site)*engine_->dof() + sigma;
+		if (index>=perThread.interned.size())
+			perThread.interned.resize(index + 1,0);
+
+		OpType*& op = perThread.interned[index];
+		if (op) return *op;
+
+		op = perThread.arena.commit(new (perThread.arena.next())
+		                            OpType(*engine_,x,site,sigma));
 		return *op;
 	}
 
 	template<typename SomeOtherType>
 	OpType& operator()(SomeOtherType& x, SizeType threadId = 0)
 	{
-		OpType* op = new OpType(x);
-		garbage_[threadId].push_back(op);
-		return *op;
+		assert(threadId < perThread_.size());
+		Arena& arena = perThread_[threadId].arena;
+		return *arena.commit(new (arena.next()) OpType(x));
 	}
 
 	OpType& operator()(const OpType* op, SizeType threadId = 0)
 	{
-		OpType* op2 = new OpType(op);
-		garbage_[threadId].push_back(op2);
-		return *op2;
+		assert(threadId < perThread_.size());
+		Arena& arena = perThread_[threadId].arena;
+		return *arena.commit(new (arena.next()) OpType(op));
+	}
+
+	// number of objects held for thread threadId
+	SizeType size(SizeType threadId = 0) const
+	{
+		assert(threadId < perThread_.size());
+		return perThread_[threadId].arena.size();
 	}
 
 private:
 
+	OperatorFactory(const ThisType&)
+	{
+		throw std::runtime_error(
+		            "OperatorFactory::copyCtor: Don't even think of coming here\n");
+	}
+
+	ThisType& operator=(const ThisType&)
+	{
+		throw std::runtime_error(
+		            "OperatorFactory::assignmentOp: Don't even think of coming here\n");
+	}
+
 	const EngineType* engine_;
-	typename PsimagLite::Vector<GarbageType>::Type garbage_;
+	typename PsimagLite::Vector<PerThreadType>::Type perThread_;
 
 }; // OperatorFactory
 } // namespace Dmrg
 
 /*@}*/
 #endif // OPERATOR_FACTORY_H
-
@@ -0,0 +1,350 @@
+// BEGIN LICENSE BLOCK
+/*
+Copyright (c) 2009-2021, UT-Battelle, LLC
+All rights reserved
+
+[FreeFermions, Version 1.0.0]
+[by G.A., Oak Ridge National Laboratory]
+
+UT Battelle Open Source Software License 11242008
+
+OPEN SOURCE LICENSE
+
+Subject to the conditions of this License, each
+contributor to this software hereby grants, free of
+charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), a
+perpetual, worldwide, non-exclusive, no-charge,
+royalty-free, irrevocable copyright license to use, copy,
+modify, merge, publish, distribute, and/or sublicense
+copies of the Software.
+
+1. Redistributions of Software must retain the above
+copyright and license notices, this list of conditions,
+and the following disclaimer.  Changes or modifications
+to, or derivative works of, the Software should be noted
+with comments and the contributor and organization's
+name.
+
+2. Neither the names of UT-Battelle, LLC or the
+Department of Energy nor the names of the Software
+contributors may be used to endorse or promote products
+derived from this software without specific prior written
+permission of UT-Battelle.
+
+3. The software and the end-user documentation included
+with the redistribution, with or without modification,
+must include the following acknowledgment:
+
+"This product includes software produced by UT-Battelle,
+LLC under Contract No. DE-AC05-00OR22725  with the
+Department of Energy."
+
+*********************************************************
+DISCLAIMER
+
+THE SOFTWARE IS SUPPLIED BY THE COPYRIGHT HOLDERS AND
+CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER, CONTRIBUTORS, UNITED STATES GOVERNMENT,
+OR THE UNITED STATES DEPARTMENT OF ENERGY BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+
+NEITHER THE UNITED STATES GOVERNMENT, NOR THE UNITED
+STATES DEPARTMENT OF ENERGY, NOR THE COPYRIGHT OWNER, NOR
+ANY OF THEIR EMPLOYEES, REPRESENTS THAT THE USE OF ANY
+INFORMATION, DATA, APPARATUS, PRODUCT, OR PROCESS
+DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+
+*********************************************************
+
+
+*/
+// END LICENSE BLOCK
+/** \ingroup DMRG */
+/*@{*/
+/*! \file ParticleHoleSpectrum.h
+ *
+ * Dynamical structure factors of free fermions from particle-hole pairs
+ *
+ * With the ne lowest levels of one flavor occupied, a one-body operator
+ * O = sum_i d_i n_i takes the ground state to the pairs p = (lambda,mu),
+ * lambda < ne occupied and mu >= ne empty, with amplitude
+ * a_p = sum_i d_i U(i,mu) U*(i,lambda) and energy E_p = E_mu - E_lambda.
+ * Then <O_L^dagger delta(omega - H + E_g) O_R> = sum_p conj(aL_p) aR_p delta(omega - E_p),
+ * plus the terms with lambda == mu at omega = 0.
+ *
+ * The energies of the pairs are found once. The amplitudes of a site
+ * (d_i a delta) cost one product per pair, those of any d one GEMM.
+ * spectrum() puts the weights in bins, each split linearly between its
+ * two nearest bins, which keeps the total weight and its mean energy.
+ * A histogram's bins are the steps of the omega grid. A kernel with a
+ * width gets bins STEPS_PER_WIDTH to a width, whatever the omega grid.
+ * These bins are then convolved with the kernel, at the cost of
+ * pairs plus bins times grid points; the error of the split is second
+ * order in the bin over the width, below 2e-3 of a peak.
+ * When there are fewer poles than bins the poles are summed exactly.
+ *
+ */
+#ifndef PARTICLE_HOLE_SPECTRUM_H
+#define PARTICLE_HOLE_SPECTRUM_H
+
+#include "Complex.h" // in PsimagLite
+#include "Matrix.h" // in PsimagLite
+#include "Vector.h" // in PsimagLite
+#include "BLAS.h" // in PsimagLite
+#include <algorithm>
+#include <cmath>
+
+namespace FreeFermions {
+
+template<typename EngineType>
+class ParticleHoleSpectrum {
+
+public:
+
+	typedef typename EngineType::RealType RealType;
+	typedef std::complex<RealType> ComplexType;
+	typedef typename PsimagLite::Vector<RealType>::Type VectorRealType;
+	typedef typename PsimagLite::Vector<ComplexType>::Type VectorComplexType;
+	typedef PsimagLite::Matrix<ComplexType> MatrixComplexType;
+
+	// HISTOGRAM is weight per unit omega in each step,
+	// RESOLVENT 1/(omega - E + i width), as OneOverZminusH
+	enum class KernelEnum {HISTOGRAM, LORENTZIAN, GAUSSIAN, RESOLVENT};
+
+	// bins per width of a Lorentzian, Gaussian or resolvent
+	static const SizeType STEPS_PER_WIDTH = 20;
+
+	// omega = offset + k*step for k = 0,...,total - 1
+	struct OmegaGridType {
+
+		OmegaGridType(SizeType t,
+		              RealType o,
+		              RealType s,
+		              KernelEnum k = KernelEnum::HISTOGRAM,
+		              RealType w = 0)
+		    : total(t), offset(o), step(s), kernel(k), width(w)
+		{}
+
+		SizeType total;
+		RealType offset;
+		RealType step;
+		KernelEnum kernel;
+		RealType width;
+	};
+
+	ParticleHoleSpectrum(const EngineType& engine,SizeType ne)
+	    : engine_(engine),
+	      ne_(ne),
+	      empty_((ne <= engine.size()) ? engine.size() - ne : 0),
+	      energies_(ne_*empty_)
+	{
+		if (ne > engine.size())
+			throw PsimagLite::RuntimeError("ParticleHoleSpectrum: more electrons than levels\n");
+
+		for (SizeType lambda=0;lambda<ne_;lambda++)
+			for (SizeType mu=0;mu<empty_;mu++)
+				energies_[mu + lambda*empty_] = engine_.eigenvalue(mu + ne_) -
+				        engine_.eigenvalue(lambda);
+	}
+
+	// pair p is lambda = p/(levels - ne), mu = ne + p%(levels - ne)
+	SizeType pairs() const { return energies_.size(); }
+
+	const VectorRealType& energies() const { return energies_; }
+
+	// a_p for O = n_site
+	void siteAmplitudes(VectorComplexType& a,SizeType site) const
+	{
+		SizeType n = engine_.size();
+		if (site >= n)
+			throw PsimagLite::RuntimeError("ParticleHoleSpectrum: no such site\n");
+
+		VectorComplexType empty(empty_);
+		for (SizeType mu=0;mu<empty_;mu++)
+			empty[mu] = engine_.eigenvector(site,mu + ne_);
+
+		a.resize(pairs());
+		for (SizeType lambda=0;lambda<ne_;lambda++) {
+			ComplexType occupied = PsimagLite::conj(ComplexType(engine_.eigenvector(site,lambda)));
+			for (SizeType mu=0;mu<empty_;mu++)
+				a[mu + lambda*empty_] = empty[mu]*occupied;
+		}
+	}
+
+	// a_p for O = sum_i d_i n_i, as one GEMM; d_i = exp(i q r_i)/sqrt(n)
+	// projects onto momentum q
+	void amplitudes(VectorComplexType& a,const VectorComplexType& d) const
+	{
+		SizeType n = engine_.size();
+		if (d.size() != n)
+			throw PsimagLite::RuntimeError("ParticleHoleSpectrum: one weight per site needed\n");
+
+		a.resize(pairs());
+		if (pairs() == 0) return;
+
+		MatrixComplexType x(n,empty_);
+		MatrixComplexType y(n,ne_);
+		for (SizeType i=0;i<n;i++) {
+			for (SizeType mu=0;mu<empty_;mu++)
+				x(i,mu) = engine_.eigenvector(i,mu + ne_);
+			for (SizeType lambda=0;lambda<ne_;lambda++)
+				y(i,lambda) = d[i]*PsimagLite::conj(ComplexType(engine_.eigenvector(i,lambda)));
+		}
+
+		// a(mu,lambda) in column-major order is a[mu + lambda*empty_]
+		int rows = empty_;
+		int cols = ne_;
+		int inner = n;
+		ComplexType one = 1.0;
+		ComplexType zero = 0.0;
+		psimag::BLAS::GEMM('T','N',rows,cols,inner,one,&(x(0,0)),inner,&(y(0,0)),inner,
+		                   zero,&(a[0]),rows);
+	}
+
+	// result[k] = sum_p conj(left_p) right_p K(omega_k - E_p); withNegative
+	// subtracts the other time ordering, the same sum with K(omega_k + E_p).
+	// Only HISTOGRAM needs a positive step
+	void spectrum(VectorComplexType& result,
+	              const VectorComplexType& left,
+	              const VectorComplexType& right,
+	              const OmegaGridType& grid,
+	              bool withNegative = false) const
+	{
+		if (left.size() != pairs() || right.size() != pairs())
+			throw PsimagLite::RuntimeError("ParticleHoleSpectrum: one amplitude per pair needed\n");
+		if (grid.kernel == KernelEnum::HISTOGRAM && grid.step <= 0)
+			throw PsimagLite::RuntimeError("ParticleHoleSpectrum: omega step must be positive\n");
+		if (grid.kernel != KernelEnum::HISTOGRAM && grid.width <= 0)
+			throw PsimagLite::RuntimeError("ParticleHoleSpectrum: kernel width must be positive\n");
+
+		result.assign(grid.total,0.0);
+		if (pairs() == 0 || grid.total == 0) return;
+
+		RealType maxPole = *std::max_element(energies_.begin(),energies_.end());
+		RealType minPole = *std::min_element(energies_.begin(),energies_.end());
+		if (withNegative) minPole = std::min(minPole,-maxPole);
+
+		if (grid.kernel == KernelEnum::HISTOGRAM) {
+			// bins at the grid's omegas, widened to hold every pole
+			RealType last = grid.offset + (grid.total - 1)*grid.step;
+			SizeType below = (minPole < grid.offset)
+			        ? static_cast<SizeType>(std::ceil((grid.offset - minPole)/grid.step)) : 0;
+			SizeType above = (maxPole > last)
+			        ? static_cast<SizeType>(std::ceil((maxPole - last)/grid.step)) : 0;
+			VectorComplexType bins(below + grid.total + above + 1,0.0);
+			fillBins(bins,grid.offset - below*grid.step,grid.step,left,right,withNegative);
+			for (SizeType k=0;k<grid.total;k++)
+				result[k] = bins[k + below]/grid.step;
+			return;
+		}
+
+		RealType binStep = grid.width/STEPS_PER_WIDTH;
+		SizeType total = static_cast<SizeType>(std::ceil((maxPole - minPole)/binStep)) + 2;
+		SizeType poles = (withNegative) ? 2*pairs() : pairs();
+		if (poles <= total) {
+			for (SizeType p=0;p<pairs();p++) {
+				ComplexType weight = PsimagLite::conj(left[p])*right[p];
+				if (weight == ComplexType(0.0)) continue;
+				addPole(result,grid,energies_[p],weight);
+				if (withNegative)
+					addPole(result,grid,-energies_[p],-weight);
+			}
+
+			return;
+		}
+
+		VectorComplexType bins(total,0.0);
+		fillBins(bins,minPole,binStep,left,right,withNegative);
+		for (SizeType b=0;b<bins.size();b++) {
+			if (bins[b] == ComplexType(0.0)) continue;
+			addPole(result,grid,minPole + b*binStep,bins[b]);
+		}
+	}
+
+private:
+
+	ParticleHoleSpectrum(const ParticleHoleSpectrum&)
+	{
+		throw PsimagLite::RuntimeError("Don't even think of coming here\n");
+	}
+
+	ParticleHoleSpectrum& operator=(const ParticleHoleSpectrum&);
+
+	// bins starting at start, step apart, get conj(left_p) right_p at
+	// E_p, and minus that at -E_p if withNegative
+	void fillBins(VectorComplexType& bins,
+	              RealType start,
+	              RealType step,
+	              const VectorComplexType& left,
+	              const VectorComplexType& right,
+	              bool withNegative) const
+	{
+		for (SizeType p=0;p<pairs();p++) {
+			ComplexType weight = PsimagLite::conj(left[p])*right[p];
+			addToBins(bins,energies_[p],weight,start,step);
+			if (withNegative)
+				addToBins(bins,-energies_[p],-weight,start,step);
+		}
+	}
+
+	static void addPole(VectorComplexType& result,
+	                    const OmegaGridType& grid,
+	                    RealType pole,
+	                    const ComplexType& weight)
+	{
+		for (SizeType k=0;k<grid.total;k++)
+			result[k] += weight*kernel(grid,grid.offset + k*grid.step - pole);
+	}
+
+	// bins is one longer than needed, for the right neighbor of the last bin
+	static void addToBins(VectorComplexType& bins,
+	                      RealType energy,
+	                      const ComplexType& weight,
+	                      RealType start,
+	                      RealType step)
+	{
+		RealType x = std::max((energy - start)/step,static_cast<RealType>(0));
+		SizeType b = std::min(static_cast<SizeType>(x),bins.size() - 2);
+		RealType f = std::min(x - b,static_cast<RealType>(1));
+		bins[b] += (1 - f)*weight;
+		bins[b + 1] += f*weight;
+	}
+
+	static ComplexType kernel(const OmegaGridType& grid,RealType x)
+	{
+		RealType w = grid.width;
+		switch (grid.kernel) {
+		case KernelEnum::LORENTZIAN:
+			return w/(M_PI*(x*x + w*w));
+		case KernelEnum::GAUSSIAN:
+			return std::exp(-0.5*x*x/(w*w))/(w*std::sqrt(2*M_PI));
+		case KernelEnum::RESOLVENT: {
+			RealType den = x*x + w*w;
+			return ComplexType(x/den,-w/den);
+		}
+		default:
+			return 0.0;
+		}
+	}
+
+	const EngineType& engine_;
+	SizeType ne_;
+	SizeType empty_;
+	VectorRealType energies_;
+}; // ParticleHoleSpectrum
+} // namespace FreeFermions
+
+/*@}*/
+#endif // PARTICLE_HOLE_SPECTRUM_H
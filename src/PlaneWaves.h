@@ -0,0 +1,287 @@
+// BEGIN LICENSE BLOCK
+/*
+Copyright (c) 2009-2021, UT-Battelle, LLC
+All rights reserved
+
+[FreeFermions, Version 1.0.0]
+[by G.A., Oak Ridge National Laboratory]
+
+UT Battelle Open Source Software License 11242008
+
+OPEN SOURCE LICENSE
+
+Subject to the conditions of this License, each
+contributor to this software hereby grants, free of
+charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), a
+perpetual, worldwide, non-exclusive, no-charge,
+royalty-free, irrevocable copyright license to use, copy,
+modify, merge, publish, distribute, and/or sublicense
+copies of the Software.
+
+1. Redistributions of Software must retain the above
+copyright and license notices, this list of conditions,
+and the following disclaimer.  Changes or modifications
+to, or derivative works of, the Software should be noted
+with comments and the contributor and organization's
+name.
+
+2. Neither the names of UT-Battelle, LLC or the
+Department of Energy nor the names of the Software
+contributors may be used to endorse or promote products
+derived from this software without specific prior written
+permission of UT-Battelle.
+
+3. The software and the end-user documentation included
+with the redistribution, with or without modification,
+must include the following acknowledgment:
+
+"This product includes software produced by UT-Battelle,
+LLC under Contract No. DE-AC05-00OR22725  with the
+Department of Energy."
+
+*********************************************************
+DISCLAIMER
+
+THE SOFTWARE IS SUPPLIED BY THE COPYRIGHT HOLDERS AND
+CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER, CONTRIBUTORS, UNITED STATES GOVERNMENT,
+OR THE UNITED STATES DEPARTMENT OF ENERGY BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+
+NEITHER THE UNITED STATES GOVERNMENT, NOR THE UNITED
+STATES DEPARTMENT OF ENERGY, NOR THE COPYRIGHT OWNER, NOR
+ANY OF THEIR EMPLOYEES, REPRESENTS THAT THE USE OF ANY
+INFORMATION, DATA, APPARATUS, PRODUCT, OR PROCESS
+DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+
+*********************************************************
+
+
+*/
+// END LICENSE BLOCK
+/** \ingroup DMRG */
+/*@{*/
+
+/*! \file PlaneWaves.h
+ *
+ * Analytic eigenbasis of a translation-invariant hopping matrix
+ *
+ * If t(i+c,j+c) = t(i,j), indices mod n, with a cell of c sites and
+ * L = n/c cells, the eigenvectors are
+ * psi(x*c+a) = exp(i k x) u_a(k)/sqrt(L), k = 2 pi m/L, where u(k) are
+ * the eigenvectors of the c x c matrix
+ * h(k)_{ab} = sum_r t(a,r*c+b) exp(i k r).
+ * Only the u(k) are kept, n*c numbers instead of n*n, and
+ * transform() runs its sums over cells as FFTs.
+ *
+ */
+#ifndef PLANE_WAVES_H
+#define PLANE_WAVES_H
+
+#include "Complex.h" // in PsimagLite
+#include "Matrix.h" // in PsimagLite
+#include "Vector.h" // in PsimagLite
+#include "EigenSolvers.h"
+#include "FastFourier.h"
+#include <algorithm>
+
+namespace FreeFermions {
+
+template<typename FieldType>
+class PlaneWaves {
+
+	typedef typename PsimagLite::Real<FieldType>::Type RealType;
+	typedef std::complex<RealType> ComplexType;
+	typedef PsimagLite::Matrix<FieldType> MatrixType;
+	typedef PsimagLite::Matrix<ComplexType> MatrixComplexType;
+	typedef typename PsimagLite::Vector<RealType>::Type VectorRealType;
+	typedef typename PsimagLite::Vector<ComplexType>::Type VectorComplexType;
+	typedef typename PsimagLite::Vector<SizeType>::Type VectorSizeType;
+	typedef FastFourier<RealType> FastFourierType;
+
+	// a non-zero t(a,r*c+b) of the first cell
+	struct BondType {
+		SizeType a;
+		SizeType b;
+		SizeType r;
+		FieldType value;
+	};
+
+public:
+
+	// Smallest cell, at least two cells long, under which m is
+	// translation invariant, or 0 if there is none;
+	// always 0 for a real field, plane waves being complex
+	static SizeType findCell(const MatrixType& m)
+	{
+		if (!PsimagLite::IsComplexNumber<FieldType>::True) return 0;
+
+		SizeType n = m.n_row();
+		for (SizeType c=1;2*c<=n;c++) {
+			if (n % c != 0) continue;
+			if (isInvariant(m,c)) return c;
+		}
+
+		return 0;
+	}
+
+	PlaneWaves(const MatrixType& m,SizeType cell)
+	    : cell_(cell),
+	      cells_(m.n_row()/cell),
+	      norm_(1.0/sqrt(static_cast<RealType>(cells_))),
+	      fft_(cells_),
+	      phases_(cells_),
+	      vectors_(cells_)
+	{
+		for (SizeType r=0;r<cells_;r++)
+			phases_[r] = std::polar<RealType>(1.0,2.0*M_PI*r/cells_);
+
+		typename PsimagLite::Vector<BondType>::Type bonds;
+		for (SizeType a=0;a<cell_;a++) {
+			for (SizeType j=0;j<m.n_col();j++) {
+				if (m(a,j) == static_cast<RealType>(0)) continue;
+				BondType bond = {a, j % cell_, j/cell_, m(a,j)};
+				bonds.push_back(bond);
+			}
+		}
+
+		SizeType n = cell_*cells_;
+		VectorRealType energies(n);
+		for (SizeType k=0;k<cells_;k++) {
+			MatrixComplexType h(cell_,cell_);
+			for (SizeType i=0;i<bonds.size();i++) {
+				const BondType& bond = bonds[i];
+				h(bond.a,bond.b) += toComplex(bond.value)*phases_[(k*bond.r) % cells_];
+			}
+
+			VectorRealType e;
+			EigenSolvers<ComplexType>::diagonalize(h,e,EigenSolverEnum::DEFAULT);
+			vectors_[k] = h;
+			for (SizeType nu=0;nu<cell_;nu++) energies[k*cell_ + nu] = e[nu];
+		}
+
+		// levels in ascending energy, (k,nu) in the order found on ties
+		order_.resize(n);
+		for (SizeType i=0;i<n;i++) order_[i] = i;
+		std::stable_sort(order_.begin(),order_.end(),[&energies](SizeType x,SizeType y)
+		{
+			return energies[x] < energies[y];
+		});
+
+		eigenvalues_.resize(n);
+		levelOf_.resize(n);
+		for (SizeType lambda=0;lambda<n;lambda++) {
+			eigenvalues_[lambda] = energies[order_[lambda]];
+			levelOf_[order_[lambda]] = lambda;
+		}
+	}
+
+	SizeType cell() const { return cell_; }
+
+	SizeType cells() const { return cells_; }
+
+	const VectorRealType& eigenvalues() const { return eigenvalues_; }
+
+	FieldType eigenvector(SizeType i,SizeType lambda) const
+	{
+		SizeType k = order_[lambda]/cell_;
+		SizeType nu = order_[lambda] % cell_;
+		SizeType x = i/cell_;
+		SizeType a = i % cell_;
+		FieldType value;
+		assign(value,phases_[(k*x) % cells_]*vectors_[k](a,nu)*norm_);
+		return value;
+	}
+
+	// m = U^dagger m U; each row of m U and each column of U^dagger (m U)
+	// is one FFT per site of the cell, followed by the c x c u(k)
+	void transform(MatrixType& m) const
+	{
+		SizeType n = cell_*cells_;
+		MatrixComplexType y(n,n);
+		VectorComplexType f(cells_);
+		for (SizeType i=0;i<n;i++) {
+			for (SizeType b=0;b<cell_;b++) {
+				for (SizeType x=0;x<cells_;x++)
+					f[x] = toComplex(m(i,x*cell_ + b));
+				fft_(f,1);
+				for (SizeType k=0;k<cells_;k++) {
+					const MatrixComplexType& u = vectors_[k];
+					for (SizeType nu=0;nu<cell_;nu++)
+						y(i,k*cell_ + nu) += f[k]*u(b,nu)*norm_;
+				}
+			}
+		}
+
+		MatrixComplexType z(n,n);
+		for (SizeType col=0;col<n;col++) {
+			for (SizeType a=0;a<cell_;a++) {
+				for (SizeType x=0;x<cells_;x++)
+					f[x] = y(x*cell_ + a,col);
+				fft_(f,-1);
+				for (SizeType k=0;k<cells_;k++) {
+					const MatrixComplexType& u = vectors_[k];
+					for (SizeType nu=0;nu<cell_;nu++)
+						z(k*cell_ + nu,col) += std::conj(u(a,nu))*f[k]*norm_;
+				}
+			}
+		}
+
+		for (SizeType i=0;i<n;i++)
+			for (SizeType j=0;j<n;j++)
+				assign(m(levelOf_[i],levelOf_[j]),z(i,j));
+	}
+
+private:
+
+	static bool isInvariant(const MatrixType& m,SizeType c)
+	{
+		SizeType n = m.n_row();
+		for (SizeType i=0;i<n;i++) {
+			SizeType ip = (i + c) % n;
+			for (SizeType j=0;j<n;j++) {
+				SizeType jp = (j + c) % n;
+				if (std::abs(m(i,j) - m(ip,jp)) > 1e-12) return false;
+			}
+		}
+
+		return true;
+	}
+
+	static ComplexType toComplex(const ComplexType& value) { return value; }
+
+	static ComplexType toComplex(const RealType& value) { return value; }
+
+	static void assign(ComplexType& dest,const ComplexType& src) { dest = src; }
+
+	static void assign(RealType&,const ComplexType&)
+	{
+		throw PsimagLite::RuntimeError("PlaneWaves: needs a complex field\n");
+	}
+
+	SizeType cell_;
+	SizeType cells_;
+	RealType norm_;
+	FastFourierType fft_;
+	VectorComplexType phases_;
+	typename PsimagLite::Vector<MatrixComplexType>::Type vectors_;
+	VectorSizeType order_;
+	VectorSizeType levelOf_;
+	VectorRealType eigenvalues_;
+}; // PlaneWaves
+} // namespace FreeFermions
+
+/*@}*/
+#endif // PLANE_WAVES_H
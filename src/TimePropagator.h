@@ -0,0 +1,243 @@
+// BEGIN LICENSE BLOCK
+/*
+Copyright (c) 2009-2021, UT-Battelle, LLC
+All rights reserved
+
+[FreeFermions, Version 1.0.0]
+[by G.A., Oak Ridge National Laboratory]
+
+UT Battelle Open Source Software License 11242008
+
+OPEN SOURCE LICENSE
+
+Subject to the conditions of this License, each
+contributor to this software hereby grants, free of
+charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), a
+perpetual, worldwide, non-exclusive, no-charge,
+royalty-free, irrevocable copyright license to use, copy,
+modify, merge, publish, distribute, and/or sublicense
+copies of the Software.
+
+1. Redistributions of Software must retain the above
+copyright and license notices, this list of conditions,
+and the following disclaimer.  Changes or modifications
+to, or derivative works of, the Software should be noted
+with comments and the contributor and organization's
+name.
+
+2. Neither the names of UT-Battelle, LLC or the
+Department of Energy nor the names of the Software
+contributors may be used to endorse or promote products
+derived from this software without specific prior written
+permission of UT-Battelle.
+
+3. The software and the end-user documentation included
+with the redistribution, with or without modification,
+must include the following acknowledgment:
+
+"This product includes software produced by UT-Battelle,
+LLC under Contract No. DE-AC05-00OR22725  with the
+Department of Energy."
+
+*********************************************************
+DISCLAIMER
+
+THE SOFTWARE IS SUPPLIED BY THE COPYRIGHT HOLDERS AND
+CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER, CONTRIBUTORS, UNITED STATES GOVERNMENT,
+OR THE UNITED STATES DEPARTMENT OF ENERGY BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+
+NEITHER THE UNITED STATES GOVERNMENT, NOR THE UNITED
+STATES DEPARTMENT OF ENERGY, NOR THE COPYRIGHT OWNER, NOR
+ANY OF THEIR EMPLOYEES, REPRESENTS THAT THE USE OF ANY
+INFORMATION, DATA, APPARATUS, PRODUCT, OR PROCESS
+DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+
+*********************************************************
+
+
+*/
+// END LICENSE BLOCK
+/** \ingroup DMRG */
+/*@{*/
+/*! \file TimePropagator.h
+ *
+ * Single-particle propagators on a grid of times
+ *
+ * G(i,j;t) = sum_lambda U(i,lambda) exp(-i E_lambda t) U*(j,lambda),
+ * with lambda over all levels, the ne occupied ones or the empty ones,
+ * and i over all sites or only some rows. The chosen columns of U are
+ * copied once; each time is then exp(-i E t) scaling the rows' part of
+ * U followed by a GEMM with U^dagger. sweep() stacks as many times as
+ * the memory budget allows into each GEMM and hands the slices out one
+ * time at a time, so that memory does not grow with the grid.
+ *
+ */
+#ifndef TIME_PROPAGATOR_H
+#define TIME_PROPAGATOR_H
+
+#include "Complex.h" // in PsimagLite
+#include "Matrix.h" // in PsimagLite
+#include "Vector.h" // in PsimagLite
+#include "BLAS.h" // in PsimagLite
+#include <algorithm>
+#include <cmath>
+
+namespace FreeFermions {
+
+template<typename EngineType>
+class TimePropagator {
+
+public:
+
+	typedef typename EngineType::RealType RealType;
+	typedef std::complex<RealType> ComplexType;
+	typedef PsimagLite::Matrix<ComplexType> MatrixComplexType;
+	typedef typename PsimagLite::Vector<SizeType>::Type VectorSizeType;
+	typedef typename PsimagLite::Vector<RealType>::Type VectorRealType;
+
+	enum class LevelsEnum {ALL, OCCUPIED, EMPTY};
+
+	static const SizeType DEFAULT_BUDGET = 268435456; // 256 MB
+
+	// No rows means every site
+	TimePropagator(const EngineType& engine,
+	               SizeType ne,
+	               LevelsEnum levels,
+	               const VectorSizeType& rows = VectorSizeType(),
+	               SizeType maxBytes = DEFAULT_BUDGET)
+	    : sites_(engine.size()),
+	      first_((levels == LevelsEnum::EMPTY) ? ne : 0),
+	      rows_(rows),
+	      maxBytes_(maxBytes)
+	{
+		if (ne > sites_)
+			throw PsimagLite::RuntimeError("TimePropagator: more electrons than levels\n");
+
+		SizeType last = (levels == LevelsEnum::OCCUPIED) ? ne : sites_;
+		SizeType k = last - first_;
+		if (rows_.size() == 0) {
+			rows_.resize(sites_);
+			for (SizeType i=0;i<sites_;i++) rows_[i] = i;
+		}
+
+		energies_.resize(k);
+		u_.resize(sites_,k);
+		uRows_.resize(rows_.size(),k);
+		for (SizeType lambda=0;lambda<k;lambda++) {
+			energies_[lambda] = engine.eigenvalue(first_ + lambda);
+			for (SizeType i=0;i<sites_;i++)
+				u_(i,lambda) = engine.eigenvector(i,first_ + lambda);
+			for (SizeType a=0;a<rows_.size();a++) {
+				if (rows_[a] >= sites_)
+					throw PsimagLite::RuntimeError("TimePropagator: no such site\n");
+				uRows_(a,lambda) = u_(rows_[a],lambda);
+			}
+		}
+	}
+
+	// slice(a,j) is G(rows()[a],j;t)
+	const VectorSizeType& rows() const { return rows_; }
+
+	// the slice at time t, valid until the next call
+	const MatrixComplexType& operator()(RealType t)
+	{
+		compute(t,0,1);
+		extract(0);
+		return slice_;
+	}
+
+	// action(it,t,slice) for t = offset + it*step, it = 0,...,total - 1
+	template<typename ActionType>
+	void sweep(SizeType total,RealType offset,RealType step,const ActionType& action)
+	{
+		SizeType bytesPerTime = rows_.size()*(sites_ + energies_.size())*sizeof(ComplexType);
+		SizeType batch = (bytesPerTime > 0) ? maxBytes_/bytesPerTime : total;
+		batch = std::max(static_cast<SizeType>(1),std::min(batch,total));
+		for (SizeType start=0;start<total;start+=batch) {
+			SizeType count = std::min(batch,total - start);
+			compute(offset + start*step,step,count);
+			for (SizeType s=0;s<count;s++) {
+				extract(s);
+				action(start + s,offset + (start + s)*step,slice_);
+			}
+		}
+	}
+
+private:
+
+	TimePropagator(const TimePropagator&)
+	{
+		throw PsimagLite::RuntimeError("Don't even think of coming here\n");
+	}
+
+	TimePropagator& operator=(const TimePropagator&);
+
+	// batch_ rows a + r*s hold time t0 + s*step, s < count, as one GEMM
+	void compute(RealType t0,RealType step,SizeType count)
+	{
+		SizeType r = rows_.size();
+		SizeType k = energies_.size();
+		SizeType m = r*count;
+		batch_.resize(m,sites_);
+		if (m == 0 || sites_ == 0) return;
+		if (k == 0) {
+			for (SizeType j=0;j<sites_;j++)
+				for (SizeType a=0;a<m;a++)
+					batch_(a,j) = 0.0;
+			return;
+		}
+
+		w_.resize(m,k);
+		for (SizeType lambda=0;lambda<k;lambda++) {
+			for (SizeType s=0;s<count;s++) {
+				RealType phase = -energies_[lambda]*(t0 + s*step);
+				ComplexType f(std::cos(phase),std::sin(phase));
+				for (SizeType a=0;a<r;a++)
+					w_(a + r*s,lambda) = uRows_(a,lambda)*f;
+			}
+		}
+
+		ComplexType one = 1.0;
+		ComplexType zero = 0.0;
+		psimag::BLAS::GEMM('N','C',m,sites_,k,one,&(w_(0,0)),m,&(u_(0,0)),sites_,
+		                   zero,&(batch_(0,0)),m);
+	}
+
+	void extract(SizeType s)
+	{
+		SizeType r = rows_.size();
+		slice_.resize(r,sites_);
+		for (SizeType j=0;j<sites_;j++)
+			for (SizeType a=0;a<r;a++)
+				slice_(a,j) = batch_(a + r*s,j);
+	}
+
+	SizeType sites_;
+	SizeType first_;
+	VectorSizeType rows_;
+	SizeType maxBytes_;
+	VectorRealType energies_;
+	MatrixComplexType u_;
+	MatrixComplexType uRows_;
+	MatrixComplexType w_;
+	MatrixComplexType batch_;
+	MatrixComplexType slice_;
+}; // TimePropagator
+} // namespace FreeFermions
+
+/*@}*/
+#endif // TIME_PROPAGATOR_H
@@ -0,0 +1,370 @@
+// BEGIN LICENSE BLOCK
+/*
+Copyright (c) 2009-2021, UT-Battelle, LLC
+All rights reserved
+
+[FreeFermions, Version 1.0.0]
+[by G.A., Oak Ridge National Laboratory]
+
+UT Battelle Open Source Software License 11242008
+
+OPEN SOURCE LICENSE
+
+Subject to the conditions of this License, each
+contributor to this software hereby grants, free of
+charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), a
+perpetual, worldwide, non-exclusive, no-charge,
+royalty-free, irrevocable copyright license to use, copy,
+modify, merge, publish, distribute, and/or sublicense
+copies of the Software.
+
+1. Redistributions of Software must retain the above
+copyright and license notices, this list of conditions,
+and the following disclaimer.  Changes or modifications
+to, or derivative works of, the Software should be noted
+with comments and the contributor and organization's
+name.
+
+2. Neither the names of UT-Battelle, LLC or the
+Department of Energy nor the names of the Software
+contributors may be used to endorse or promote products
+derived from this software without specific prior written
+permission of UT-Battelle.
+
+3. The software and the end-user documentation included
+with the redistribution, with or without modification,
+must include the following acknowledgment:
+
+"This product includes software produced by UT-Battelle,
+LLC under Contract No. DE-AC05-00OR22725  with the
+Department of Energy."
+
+*********************************************************
+DISCLAIMER
+
+THE SOFTWARE IS SUPPLIED BY THE COPYRIGHT HOLDERS AND
+CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER, CONTRIBUTORS, UNITED STATES GOVERNMENT,
+OR THE UNITED STATES DEPARTMENT OF ENERGY BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+
+NEITHER THE UNITED STATES GOVERNMENT, NOR THE UNITED
+STATES DEPARTMENT OF ENERGY, NOR THE COPYRIGHT OWNER, NOR
+ANY OF THEIR EMPLOYEES, REPRESENTS THAT THE USE OF ANY
+INFORMATION, DATA, APPARATUS, PRODUCT, OR PROCESS
+DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+
+*********************************************************
+
+
+*/
+// END LICENSE BLOCK
+/** \ingroup DMRG */
+/*@{*/
+
+/*! \file WickDeterminant.h
+ *
+ * Evaluates <occupations2| O_k ... O_1 |occupations> for one flavor
+ * as a determinant of single-particle contractions, instead of
+ * enumerating lambda indices as HilbertState's default backend does.
+ *
+ * When bra and ket have the same occupations the occupied levels
+ * are integrated out, and the determinant is m x m, where m is the
+ * number of destruction operators in the string. Otherwise the
+ * occupied levels are kept explicitly.
+ *
+ * Diagonal operators must be factorizable into per-operator weights,
+ * see weight() in EToTheIhTime and EToTheBetaH.
+ *
+ * Like the enumeration backend, it gives zero unless bra and ket
+ * have the same filling; examples/wickVsEnumeration checks both agree.
+ */
+#ifndef WICK_DETERMINANT_H
+#define WICK_DETERMINANT_H
+
+#include "Complex.h" // in PsimagLite
+#include "Matrix.h" // in PsimagLite
+#include "FreeOperators.h"
+
+namespace FreeFermions {
+
+template<typename CorDOperatorType,
+         typename DiagonalOperatorType,
+         typename OpPointerType>
+class WickDeterminant {
+
+	typedef typename CorDOperatorType::EngineType EngineType;
+	typedef typename CorDOperatorType::RealType RealType;
+	typedef typename CorDOperatorType::FieldType FieldType;
+	typedef FreeOperators<CorDOperatorType,OpPointerType> FreeOperatorsType;
+	typedef PsimagLite::Matrix<FieldType> MatrixType;
+	typedef typename PsimagLite::Vector<FieldType>::Type VectorType;
+	typedef typename PsimagLite::Vector<SizeType>::Type VectorSizeType;
+	typedef typename PsimagLite::Vector<OpPointerType>::Type VectorOpPointerType;
+	typedef typename PsimagLite::Vector<const CorDOperatorType*>::Type
+	VectorCorDOperatorType;
+	typedef typename PsimagLite::Vector<const DiagonalOperatorType*>::Type
+	VectorDiagonalOperatorType;
+
+	enum {CREATION = CorDOperatorType::CREATION,
+		  DESTRUCTION = CorDOperatorType::DESTRUCTION};
+
+public:
+
+	WickDeterminant(const EngineType& engine,
+	                const VectorOpPointerType& opPointers,
+	                const VectorCorDOperatorType& operatorsCreation,
+	                const VectorCorDOperatorType& operatorsDestruction,
+	                const VectorDiagonalOperatorType& operatorsDiagonal)
+	    : engine_(engine),
+	      opPointers_(opPointers),
+	      operatorsCreation_(operatorsCreation),
+	      operatorsDestruction_(operatorsDestruction),
+	      operatorsDiagonal_(operatorsDiagonal)
+	{}
+
+	FieldType operator()(SizeType sigma,
+	                     const VectorSizeType& occupations,
+	                     const VectorSizeType& occupations2) const
+	{
+		// middle operators of flavor sigma, in the order they were applied
+		VectorSizeType middle;
+		SizeType creations = 0;
+		for (SizeType i = 0; i < opPointers_.size(); ++i) {
+			SizeType type = opPointers_[i].type;
+			if (type != CREATION && type != DESTRUCTION) continue;
+			if (opPointers_[i].sigma != sigma) continue;
+			middle.push_back(i);
+			if (type == CREATION) ++creations;
+		}
+
+		SizeType n = engine_.size();
+		SizeType ne = countOccupied(occupations);
+		SizeType ne2 = countOccupied(occupations2);
+		SizeType destructions = middle.size() - creations;
+		// same rule as the enumeration backend, see FreeOperators:
+		// fillings and numbers of daggers and non-daggers must match
+		if (ne != ne2 || creations != destructions) return 0.0;
+
+		VectorType ketWeight(n, 1.0);
+		for (SizeType lambda = 0; lambda < n; ++lambda) {
+			if (occupations[lambda] == 0) continue;
+			ketWeight[lambda] = weight(0, CREATION, lambda);
+		}
+
+		// coefficients of each middle operator on the eigenbasis,
+		// including the weights of the diagonal operators applied after it
+		MatrixType coeffs(n, middle.size());
+		for (SizeType j = 0; j < middle.size(); ++j) {
+			const OpPointerType& opPointer = opPointers_[middle[j]];
+			const CorDOperatorType* op = (opPointer.type == CREATION) ?
+			            operatorsCreation_[opPointer.index] :
+			            operatorsDestruction_[opPointer.index];
+			for (SizeType lambda = 0; lambda < n; ++lambda)
+				coeffs(lambda, j) = op->operator()(lambda)*
+				        weight(middle[j] + 1, opPointer.type, lambda);
+		}
+
+		if (occupations == occupations2)
+			return reduced(middle, coeffs, occupations, ketWeight);
+
+		return full(middle, coeffs, occupations, occupations2, ketWeight);
+	}
+
+private:
+
+	// Bra and ket are equal: integrate out the occupied levels.
+	// The contraction of a destruction operator a with a creation operator b
+	// is sum_lambda alpha_a beta_b (1 - n_lambda) if b was applied before a,
+	// and - sum_lambda alpha_a beta_b n_lambda otherwise
+	FieldType reduced(const VectorSizeType& middle,
+	                  const MatrixType& coeffs,
+	                  const VectorSizeType& occupations,
+	                  const VectorType& ketWeight) const
+	{
+		VectorSizeType rows;
+		VectorSizeType cols;
+		SizeType sign = splitByType(rows, cols, middle);
+		SizeType m = rows.size();
+
+		FieldType prefactor = (sign & 1) ? -1.0 : 1.0;
+		if ((m*(m - 1)/2) & 1) prefactor = -prefactor;
+		for (SizeType lambda = 0; lambda < occupations.size(); ++lambda)
+			if (occupations[lambda] != 0) prefactor *= ketWeight[lambda];
+
+		if (m == 0) return prefactor;
+
+		SizeType n = engine_.size();
+		MatrixType s(m, m);
+		for (SizeType a = 0; a < m; ++a) {
+			for (SizeType b = 0; b < m; ++b) {
+				bool particle = (middle[cols[b]] < middle[rows[a]]);
+				FieldType sum = 0.0;
+				for (SizeType lambda = 0; lambda < n; ++lambda) {
+					bool occupied = (occupations[lambda] != 0);
+					if (occupied == particle) continue;
+					sum += coeffs(lambda, rows[a])*coeffs(lambda, cols[b]);
+				}
+
+				s(a, b) = (particle) ? sum : -sum;
+			}
+		}
+
+		return prefactor*determinant(s);
+	}
+
+	// Bra and ket differ: keep their occupied levels explicitly in
+	// <0| bra_annihilators middle_reversed ket_creators |0>
+	FieldType full(const VectorSizeType& middle,
+	               const MatrixType& coeffs,
+	               const VectorSizeType& occupations,
+	               const VectorSizeType& occupations2,
+	               const VectorType& ketWeight) const
+	{
+		VectorSizeType rows;
+		VectorSizeType cols;
+		SizeType sign = splitByType(rows, cols, middle);
+
+		VectorSizeType bra;
+		for (SizeType lambda = 0; lambda < occupations2.size(); ++lambda)
+			if (occupations2[lambda] != 0) bra.push_back(lambda);
+
+		VectorSizeType ket;
+		for (SizeType i = 0; i < occupations.size(); ++i) {
+			SizeType lambda = occupations.size() - i - 1;
+			if (occupations[lambda] != 0) ket.push_back(lambda);
+		}
+
+		SizeType total = bra.size() + rows.size();
+		assert(total == ket.size() + cols.size());
+		if (total == 0) return 1.0;
+
+		SizeType n = engine_.size();
+		MatrixType g(total, total);
+		for (SizeType a = 0; a < bra.size(); ++a) {
+			for (SizeType b = 0; b < cols.size(); ++b)
+				g(a, b) = coeffs(bra[a], cols[b]);
+			for (SizeType b = 0; b < ket.size(); ++b)
+				if (bra[a] == ket[b]) g(a, b + cols.size()) = ketWeight[ket[b]];
+		}
+
+		for (SizeType a = 0; a < rows.size(); ++a) {
+			SizeType row = a + bra.size();
+			for (SizeType b = 0; b < cols.size(); ++b) {
+				if (middle[cols[b]] > middle[rows[a]]) continue;
+				FieldType sum = 0.0;
+				for (SizeType lambda = 0; lambda < n; ++lambda)
+					sum += coeffs(lambda, rows[a])*coeffs(lambda, cols[b]);
+				g(row, b) = sum;
+			}
+
+			for (SizeType b = 0; b < ket.size(); ++b)
+				g(row, b + cols.size()) = coeffs(ket[b], rows[a])*ketWeight[ket[b]];
+		}
+
+		FieldType value = determinant(g);
+		if (sign & 1) value = -value;
+		if ((total*(total - 1)/2) & 1) value = -value;
+		return value;
+	}
+
+	// Splits middle operators into destructions (rows) and creations (cols),
+	// both in the order they appear in <bra|O_k...O_1|ket>, and returns
+	// the number of transpositions needed to move destructions to the left
+	SizeType splitByType(VectorSizeType& rows,
+	                     VectorSizeType& cols,
+	                     const VectorSizeType& middle) const
+	{
+		SizeType sign = 0;
+		for (SizeType i = 0; i < middle.size(); ++i) {
+			SizeType j = middle.size() - i - 1;
+			if (opPointers_[middle[j]].type == CREATION) {
+				cols.push_back(j);
+				continue;
+			}
+
+			sign += cols.size();
+			rows.push_back(j);
+		}
+
+		return sign;
+	}
+
+	// product of the weights of the diagonal operators
+	// located at or after start in the string
+	FieldType weight(SizeType start, SizeType type, SizeType lambda) const
+	{
+		FieldType prod = 1.0;
+		for (SizeType i = start; i < opPointers_.size(); ++i) {
+			SizeType type2 = opPointers_[i].type;
+			if (type2 == CREATION || type2 == DESTRUCTION) continue;
+			const DiagonalOperatorType* op = operatorsDiagonal_[opPointers_[i].index];
+			prod *= op->template weight<FreeOperatorsType>(type, lambda);
+		}
+
+		return prod;
+	}
+
+	static SizeType countOccupied(const VectorSizeType& occupations)
+	{
+		SizeType counter = 0;
+		for (SizeType i = 0; i < occupations.size(); ++i)
+			if (occupations[i] != 0) ++counter;
+		return counter;
+	}
+
+	// LU decomposition with partial pivoting; m is overwritten
+	static FieldType determinant(MatrixType& m)
+	{
+		SizeType n = m.n_row();
+		FieldType det = 1.0;
+		for (SizeType k = 0; k < n; ++k) {
+			SizeType pivot = k;
+			RealType maxValue = std::abs(m(k, k));
+			for (SizeType i = k + 1; i < n; ++i) {
+				RealType tmp = std::abs(m(i, k));
+				if (tmp <= maxValue) continue;
+				maxValue = tmp;
+				pivot = i;
+			}
+
+			if (maxValue == 0) return 0.0;
+
+			if (pivot != k) {
+				for (SizeType j = k; j < n; ++j) std::swap(m(k, j), m(pivot, j));
+				det = -det;
+			}
+
+			det *= m(k, k);
+			for (SizeType i = k + 1; i < n; ++i) {
+				FieldType factor = m(i, k)/m(k, k);
+				if (factor == FieldType(0.0)) continue;
+				for (SizeType j = k + 1; j < n; ++j) m(i, j) -= factor*m(k, j);
+			}
+		}
+
+		return det;
+	}
+
+	const EngineType& engine_;
+	const VectorOpPointerType& opPointers_;
+	const VectorCorDOperatorType& operatorsCreation_;
+	const VectorCorDOperatorType& operatorsDestruction_;
+	const VectorDiagonalOperatorType& operatorsDiagonal_;
+}; // WickDeterminant
+} // namespace FreeFermions
+
+/*@}*/
+#endif // WICK_DETERMINANT_H
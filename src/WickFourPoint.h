@@ -0,0 +1,218 @@
+// BEGIN LICENSE BLOCK
+/*
+Copyright (c) 2009-2021, UT-Battelle, LLC
+All rights reserved
+
+[FreeFermions, Version 1.0.0]
+[by G.A., Oak Ridge National Laboratory]
+
+UT Battelle Open Source Software License 11242008
+
+OPEN SOURCE LICENSE
+
+Subject to the conditions of this License, each
+contributor to this software hereby grants, free of
+charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), a
+perpetual, worldwide, non-exclusive, no-charge,
+royalty-free, irrevocable copyright license to use, copy,
+modify, merge, publish, distribute, and/or sublicense
+copies of the Software.
+
+1. Redistributions of Software must retain the above
+copyright and license notices, this list of conditions,
+and the following disclaimer.  Changes or modifications
+to, or derivative works of, the Software should be noted
+with comments and the contributor and organization's
+name.
+
+2. Neither the names of UT-Battelle, LLC or the
+Department of Energy nor the names of the Software
+contributors may be used to endorse or promote products
+derived from this software without specific prior written
+permission of UT-Battelle.
+
+3. The software and the end-user documentation included
+with the redistribution, with or without modification,
+must include the following acknowledgment:
+
+"This product includes software produced by UT-Battelle,
+LLC under Contract No. DE-AC05-00OR22725  with the
+Department of Energy."
+
+*********************************************************
+DISCLAIMER
+
+THE SOFTWARE IS SUPPLIED BY THE COPYRIGHT HOLDERS AND
+CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER, CONTRIBUTORS, UNITED STATES GOVERNMENT,
+OR THE UNITED STATES DEPARTMENT OF ENERGY BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+
+NEITHER THE UNITED STATES GOVERNMENT, NOR THE UNITED
+STATES DEPARTMENT OF ENERGY, NOR THE COPYRIGHT OWNER, NOR
+ANY OF THEIR EMPLOYEES, REPRESENTS THAT THE USE OF ANY
+INFORMATION, DATA, APPARATUS, PRODUCT, OR PROCESS
+DISCLOSED WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+
+*********************************************************
+
+
+*/
+// END LICENSE BLOCK
+/** \ingroup DMRG */
+/*@{*/
+
+/*! \file WickFourPoint.h
+ *
+ * Four-point ground-state correlators from two-point ones
+ *
+ * For free fermions, with C^s(i,j) = <c^dagger_{i,s} c_{j,s}>,
+ * Wick's theorem gives
+ * <n_{i,s} n_{j,s'}> = C^s(i,i) C^s'(j,j) + delta_{ss'} C^s(i,j) (delta_ij - C^s(j,i))
+ * <c^dagger_{i,s} c_{i,s'} c^dagger_{j,s'} c_{j,s}> = C^s(i,j) (delta_ij - C^s'(j,i)) if s != s'
+ * so that each n x n correlator costs O(n^2), rows done in parallel.
+ * Each flavor's matrix is typically from CorrelationMatrix, covering
+ * every orbital.
+ *
+ */
+#ifndef WICK_FOUR_POINT_H
+#define WICK_FOUR_POINT_H
+
+#include "Complex.h" // in PsimagLite
+#include "Matrix.h" // in PsimagLite
+#include "Vector.h" // in PsimagLite
+#include "Parallelizer2.h" // in PsimagLite
+
+namespace FreeFermions {
+
+template<typename FieldType>
+class WickFourPoint {
+
+	enum {SPIN_UP, SPIN_DOWN};
+
+public:
+
+	typedef typename PsimagLite::Real<FieldType>::Type RealType;
+	typedef PsimagLite::Matrix<FieldType> MatrixType;
+	typedef typename PsimagLite::Vector<FieldType>::Type VectorFieldType;
+
+	// spinless
+	WickFourPoint(const MatrixType& c)
+	    : flavors_(1,&c)
+	{}
+
+	// the same matrix may be given twice
+	WickFourPoint(const MatrixType& up,const MatrixType& down)
+	    : flavors_(2,&up)
+	{
+		flavors_[SPIN_DOWN] = &down;
+		if (up.n_row() != down.n_row())
+			throw PsimagLite::RuntimeError("WickFourPoint: flavors of different sizes\n");
+	}
+
+	SizeType size() const { return flavors_[0]->n_row(); }
+
+	// <n_i n_j> with n_i summed over flavors
+	void densityDensity(MatrixType& m) const
+	{
+		VectorFieldType density(size(),0.0);
+		for (SizeType s=0;s<flavors_.size();s++)
+			for (SizeType i=0;i<size();i++)
+				density[i] += (*flavors_[s])(i,i);
+
+		fill(m,density,1.0);
+	}
+
+	// <S^z_i S^z_j>, S^z = (n_up - n_down)/2
+	void szSz(MatrixType& m) const
+	{
+		checkSpin("szSz");
+		VectorFieldType sz(size());
+		const MatrixType& up = *flavors_[SPIN_UP];
+		const MatrixType& down = *flavors_[SPIN_DOWN];
+		for (SizeType i=0;i<size();i++)
+			sz[i] = 0.5*(up(i,i) - down(i,i));
+
+		fill(m,sz,0.25);
+	}
+
+	// <S^+_i S^-_j> = <c^dagger_{i,up} c_{i,down} c^dagger_{j,down} c_{j,up}>
+	void splusSminus(MatrixType& m) const
+	{
+		checkSpin("splusSminus");
+		spinFlip(m,*flavors_[SPIN_UP],*flavors_[SPIN_DOWN]);
+	}
+
+	// <S^-_i S^+_j> = <c^dagger_{i,down} c_{i,up} c^dagger_{j,up} c_{j,down}>
+	void sminusSplus(MatrixType& m) const
+	{
+		checkSpin("sminusSplus");
+		spinFlip(m,*flavors_[SPIN_DOWN],*flavors_[SPIN_UP]);
+	}
+
+private:
+
+	typedef PsimagLite::Parallelizer2<> ParallelizerType;
+	typedef typename PsimagLite::Vector<const MatrixType*>::Type VectorMatrixPointerType;
+
+	// m(i,j) = local[i]*local[j] + factor*sum_s C^s(i,j) (delta_ij - C^s(j,i))
+	void fill(MatrixType& m,const VectorFieldType& local,RealType factor) const
+	{
+		SizeType n = size();
+		m.resize(n,n);
+		const VectorMatrixPointerType& flavors = flavors_;
+		ParallelizerType parallelizer(PsimagLite::Concurrency::codeSectionParams);
+		parallelizer.parallelFor(0,n,[&m,&local,&flavors,factor,n](SizeType i,SizeType)
+		{
+			for (SizeType j=0;j<n;j++) {
+				FieldType exchange = 0.0;
+				for (SizeType s=0;s<flavors.size();s++) {
+					const MatrixType& c = *flavors[s];
+					FieldType hole = (i == j) ? 1.0 - c(j,i) : -c(j,i);
+					exchange += c(i,j)*hole;
+				}
+
+				m(i,j) = local[i]*local[j] + factor*exchange;
+			}
+		});
+	}
+
+	// m(i,j) = a(i,j) (delta_ij - b(j,i))
+	static void spinFlip(MatrixType& m,const MatrixType& a,const MatrixType& b)
+	{
+		SizeType n = a.n_row();
+		m.resize(n,n);
+		ParallelizerType parallelizer(PsimagLite::Concurrency::codeSectionParams);
+		parallelizer.parallelFor(0,n,[&m,&a,&b,n](SizeType i,SizeType)
+		{
+			for (SizeType j=0;j<n;j++) {
+				FieldType hole = (i == j) ? 1.0 - b(j,i) : -b(j,i);
+				m(i,j) = a(i,j)*hole;
+			}
+		});
+	}
+
+	void checkSpin(PsimagLite::String what) const
+	{
+		if (flavors_.size() == 2) return;
+		throw PsimagLite::RuntimeError("WickFourPoint::" + what + "(): needs two spins\n");
+	}
+
+	VectorMatrixPointerType flavors_;
+}; // WickFourPoint
+} // namespace FreeFermions
+
+/*@}*/
+#endif // WICK_FOUR_POINT_H